@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct HostCpu {
+    int cpu = -1;
+    int numaNode = -1;
+};
+
+// Parses a sysfs cpulist such as "0-3,8-11".
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            for (int c = first; c <= last; ++c) cpus.push_back(c);
+        } catch (...) {}
+    }
+    return cpus;
+}
+
+// Host CPUs this process may run on, grouped by NUMA node.
+inline std::vector<HostCpu> hostCpus() {
+    std::vector<HostCpu> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &allowed)) cpus.push_back({ c, 0 });
+    }
+
+    for (int node = 0; node < 64; ++node) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in.is_open()) continue;
+        std::string list;
+        std::getline(in, list);
+        for (int c : parseCpuList(list)) {
+            for (auto& hc : cpus)
+                if (hc.cpu == c) hc.numaNode = node;
+        }
+    }
+
+    std::stable_sort(cpus.begin(), cpus.end(), [](const HostCpu& a, const HostCpu& b) {
+        return a.numaNode < b.numaNode;
+    });
+#endif
+    if (cpus.empty()) {
+        int n = std::max(1u, std::thread::hardware_concurrency());
+        for (int c = 0; c < n; ++c) cpus.push_back({ c, -1 });
+    }
+    return cpus;
+}
+
+// Simulated core i goes to the i-th allowed host CPU, filling one NUMA node before the next.
+inline std::vector<HostCpu> planCoreAffinity(int numCores) {
+    std::vector<HostCpu> cpus = hostCpus();
+    std::vector<HostCpu> plan;
+    for (int i = 0; i < numCores; ++i)
+        plan.push_back(cpus[i % cpus.size()]);
+    return plan;
+}
+
+inline bool pinCurrentThread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// The single host CPU a thread is bound to, or -1 if it may float.
+inline int pinnedCpuOf(std::thread& t) {
+#ifdef __linux__
+    if (!t.joinable()) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(t.native_handle(), sizeof(set), &set) != 0) return -1;
+    if (CPU_COUNT(&set) != 1) return -1;
+    for (int c = 0; c < CPU_SETSIZE; ++c)
+        if (CPU_ISSET(c, &set)) return c;
+#else
+    (void)t;
+#endif
+    return -1;
+}
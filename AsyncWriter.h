@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+
+// Background file writer for reports and dumps. Callers format a complete snapshot
+// into a string and hand it over; submit() only swaps it into the back buffer, so
+// monitoring never waits on the filesystem. The I/O thread swaps the two buffers
+// and writes the whole batch at once, merging consecutive writes to the same file.
+class AsyncWriter {
+private:
+    struct Job {
+        std::string filename;
+        std::string content;
+        bool append;
+    };
+
+    std::vector<Job> back;       // filled by callers under mtx
+    std::vector<Job> front;      // drained by the I/O thread without the lock
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::condition_variable idleCv;
+    std::thread worker;
+    bool running = false;
+    bool busy = false;
+
+public:
+    ~AsyncWriter() { stop(); }
+
+    void submit(std::string filename, std::string content, bool append = false) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) {
+            running = true;
+            worker = std::thread([this]() { run(); });
+        }
+        // Truncating rewrite of a file that is still queued supersedes the queued content.
+        if (!append && !back.empty() && back.back().filename == filename)
+            back.back() = Job{ std::move(filename), std::move(content), false };
+        else if (append && !back.empty() && back.back().filename == filename)
+            back.back().content += content;
+        else
+            back.push_back(Job{ std::move(filename), std::move(content), append });
+        cv.notify_one();
+    }
+
+    // Blocks until everything submitted so far is on disk.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mtx);
+        idleCv.wait(lock, [this]() { return back.empty() && !busy; });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running) return;
+            running = false;
+        }
+        cv.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this]() { return !back.empty() || !running; });
+            if (back.empty()) break;   // stopping, nothing left to write
+
+            front.swap(back);
+            busy = true;
+            lock.unlock();
+
+            for (Job& job : front) {
+                std::ofstream ofs(job.filename, job.append ? std::ios::app : std::ios::trunc);
+                if (!ofs.is_open()) {
+                    std::cerr << "Unable to open file: " << job.filename << "\n";
+                    continue;
+                }
+                ofs.write(job.content.data(), static_cast<std::streamsize>(job.content.size()));
+            }
+            front.clear();
+
+            lock.lock();
+            busy = false;
+            idleCv.notify_all();
+        }
+    }
+};
+
+extern AsyncWriter fileWriter;
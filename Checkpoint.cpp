@@ -0,0 +1,174 @@
+#include "Checkpoint.h"
+#include "CheckpointIO.h"
+#include "Scheduler.h"
+#include "MemoryManager.h"
+#include "CoreCounters.h"
+#include "process_list.h"
+#include "globals.h"
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+extern MemoryManager memmgr;
+
+static const char MAGIC[8] = { 'C', 'S', 'O', 'P', 'C', 'K', 'P', 'T' };
+static const uint32_t VERSION = 2;   // 2 adds the generator RNG state
+
+static std::string encode(Scheduler& sched) {
+    CheckpointWriter w;
+    w.bytes(MAGIC, sizeof MAGIC);
+    w.u32(VERSION);
+    w.i64(schedulerClockMs());
+    w.i64(simTick.load());
+    w.i32(processCounter.load());
+    sched.saveGeneratorState(w);
+
+    coreCounters.saveState(w);
+    memmgr.saveState(w);
+
+    std::unordered_map<const Process*, uint64_t> sleepLeft;
+    for (const auto& [proc, ticks] : sched.sleepingProcesses()) sleepLeft[proc] = ticks;
+
+    auto procs = sched.allProcesses.getAllProcesses();
+    w.u32(static_cast<uint32_t>(procs.size()));
+    for (const auto& p : procs) {
+        auto it = sleepLeft.find(p.get());
+        p->saveState(w, it == sleepLeft.end() ? 0 : static_cast<int>(it->second));
+    }
+    return w.data();
+}
+
+size_t saveCheckpoint(Scheduler& sched, const std::string& path) {
+    bool wasRunning = sched.pause();
+    std::string image;
+    try {
+        image = encode(sched);
+    } catch (...) {
+        if (wasRunning) sched.resume();
+        throw;
+    }
+    if (wasRunning) sched.resume();
+
+    // Write beside the target and rename, so a crash never leaves half an image.
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) throw std::runtime_error("Unable to open file: " + tmp);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!out) throw std::runtime_error("Failed writing checkpoint: " + tmp);
+    }
+    std::filesystem::rename(tmp, path);
+    return image.size();
+}
+
+// The image is parsed in place from a read-only mapping; if the file can't be
+// mapped, or the platform has no mmap, it is read into memory instead.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::string fallback;
+
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Unable to open file: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = static_cast<size_t>(st.st_size);
+            void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const char*>(p);
+                mapped = true;
+            }
+        }
+        ::close(fd);
+#endif
+
+        if (!mapped) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open()) throw std::runtime_error("Unable to open file: " + path);
+            fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            data = fallback.data();
+            size = fallback.size();
+        }
+    }
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped) ::munmap(const_cast<char*>(data), size);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    CheckpointReader reader() const { return CheckpointReader(data, size); }
+};
+
+size_t restoreCheckpoint(Scheduler& sched, const std::string& path) {
+    if (cpuRunning || sched.allProcesses.size() > 0)
+        throw std::runtime_error("restore needs a fresh emulator: run it before scheduler-start and before creating processes.");
+
+    MappedFile file(path);
+    CheckpointReader r = file.reader();
+
+    char magic[sizeof MAGIC];
+    r.bytes(magic, sizeof magic);
+    if (std::memcmp(magic, MAGIC, sizeof MAGIC) != 0)
+        throw std::runtime_error(path + " is not a csopesy checkpoint.");
+    uint32_t version = r.u32();
+    if (version != 1 && version != VERSION)
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version) + ".");
+
+    // The whole image is parsed and checked into staging first; a truncated or corrupt
+    // file throws before any emulator state changes, so the restore can be retried.
+    long long savedClock = r.i64();
+    long savedTick = static_cast<long>(r.i64());
+    // Scheduler-clock fields are moved onto this run's clock (the steady clock restarts with the host).
+    long long clockShift = schedulerClockMs() - savedClock;
+    int savedCounter = r.i32();
+    bool hasGenerator = version >= 2;
+    Rng generator;
+    if (hasGenerator) generator = Scheduler::readGeneratorState(r);
+
+    auto counters = std::make_unique<CoreCounters>();
+    counters->restoreState(r);
+    MemoryManager pager;
+    pager.restoreState(r);
+
+    uint32_t count = r.count(64);   // a process's fixed fields alone are over 64 bytes
+    std::vector<std::shared_ptr<Process>> procs;
+    std::unordered_set<std::string> names;
+    for (uint32_t i = 0; i < count; ++i) {
+        procs.push_back(makeProcess(r, clockShift));
+        if (!names.insert(procs.back()->getProcessName()).second)
+            throw std::runtime_error("Checkpoint contains a duplicate process name.");
+    }
+    if (!r.atEnd()) throw std::runtime_error("Checkpoint has trailing data.");
+
+    simTick = savedTick;
+    processCounter = savedCounter;
+    if (hasGenerator) sched.setGeneratorState(generator);
+    coreCounters.copyEventsFrom(*counters);
+    memmgr.takeStateFrom(pager);
+
+    for (auto& p : procs) {
+        Process* proc = sched.allProcesses.addProcess(std::move(p)).get();
+        if (proc->getState() == ProcessState::WAITING)
+            sched.restoreSleeper(proc);
+        else if (proc->getState() == ProcessState::FINISHED && !proc->isArchived())
+            sched.retire(proc);
+    }
+    return count;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+
+class Scheduler;
+
+// checkpoint <file>: pauses the scheduler, writes every process (program counter,
+// symbol table, state, logs), the frames, the backing store, the counters and the
+// PID counter to one binary image, then resumes. Returns the image size in bytes.
+size_t saveCheckpoint(Scheduler& sched, const std::string& path);
+
+// restore <file>: loads an image into a fresh emulator (no processes yet, scheduler
+// not started); scheduler-start then continues the run. Returns the process count.
+size_t restoreCheckpoint(Scheduler& sched, const std::string& path);
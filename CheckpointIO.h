@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+// Little-endian-as-host binary encoding used by checkpoint/restore. Fixed-width
+// integers are copied raw; strings are a u32 length followed by the bytes.
+class CheckpointWriter {
+private:
+    std::string buf;
+
+public:
+    void bytes(const void* p, size_t n) { buf.append(static_cast<const char*>(p), n); }
+    void u8(uint8_t v) { bytes(&v, sizeof v); }
+    void u32(uint32_t v) { bytes(&v, sizeof v); }
+    void i32(int32_t v) { bytes(&v, sizeof v); }
+    void i64(int64_t v) { bytes(&v, sizeof v); }
+    void u64(uint64_t v) { bytes(&v, sizeof v); }
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes(s.data(), s.size());
+    }
+
+    const std::string& data() const { return buf; }
+};
+
+// Reads straight out of a mapped (or loaded) checkpoint image; throws on a short file.
+class CheckpointReader {
+private:
+    const char* pos;
+    const char* end;
+
+public:
+    CheckpointReader(const char* data, size_t size) : pos(data), end(data + size) {}
+
+    void bytes(void* out, size_t n) {
+        if (static_cast<size_t>(end - pos) < n) throw std::runtime_error("Checkpoint is truncated.");
+        std::memcpy(out, pos, n);
+        pos += n;
+    }
+    uint8_t u8() { uint8_t v; bytes(&v, sizeof v); return v; }
+    uint32_t u32() { uint32_t v; bytes(&v, sizeof v); return v; }
+    int32_t i32() { int32_t v; bytes(&v, sizeof v); return v; }
+    int64_t i64() { int64_t v; bytes(&v, sizeof v); return v; }
+    uint64_t u64() { uint64_t v; bytes(&v, sizeof v); return v; }
+    std::string str() {
+        uint32_t n = u32();
+        if (static_cast<size_t>(end - pos) < n) throw std::runtime_error("Checkpoint is truncated.");
+        std::string s(pos, n);
+        pos += n;
+        return s;
+    }
+
+    // Element count for a container whose entries take at least `minBytes` each. A count
+    // the rest of the image cannot hold is corrupt, and is rejected before anything is
+    // sized from it.
+    uint32_t count(size_t minBytes) {
+        uint32_t n = u32();
+        if (n > remaining() / minBytes) throw std::runtime_error("Checkpoint is corrupt: count exceeds image size.");
+        return n;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end - pos); }
+    bool atEnd() const { return pos == end; }
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include "CheckpointIO.h"
+
+// Aggregate counters kept up to date as things happen, instead of being recomputed
+// by walking every process. Each core thread updates its own cache-line-aligned
+// shard, so the hot path never shares a line with another core; readers add the
+// shards up. Threads that are not cores (REPL, generator, timer) share shard 0.
+// Each shard fills its own page, so with cpu-affinity on the kernel's first-touch
+// policy can put it on its core's NUMA node (see claimLocal).
+struct alignas(4096) CounterShard {
+    std::atomic<long> activeTicks{0};
+    std::atomic<long> idleTicks{0};
+    std::atomic<long> instructions{0};
+    std::atomic<long> pageFaults{0};
+    std::atomic<long> contextSwitches{0};
+    std::atomic<long> memoryUsed{0};
+    std::atomic<long> pagedIn{0};
+    std::atomic<long> pagedOut{0};
+    std::atomic<long> inState[4] = {};   // indexed by ProcessState
+};
+
+class CoreCounters {
+public:
+    static constexpr int MAX_SHARDS = 129;
+
+private:
+    CounterShard shards[MAX_SHARDS];
+    static inline thread_local int threadShard = 0;
+
+public:
+    long total(std::atomic<long> CounterShard::*field) const {
+        long sum = 0;
+        for (const auto& s : shards) sum += (s.*field).load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    // One core's own value, for per-core breakdowns.
+    long ofCore(int coreId, std::atomic<long> CounterShard::*field) const {
+        return (shards[1 + coreId % (MAX_SHARDS - 1)].*field).load(std::memory_order_relaxed);
+    }
+
+    // Core threads call this once so their updates land in their own shard.
+    static void bindThreadToCore(int coreId) {
+        threadShard = 1 + coreId % (MAX_SHARDS - 1);
+    }
+
+    // Shard index of the calling thread (0 = not a core), reused by PerfStats.
+    static int currentShard() { return threadShard; }
+    static int shardOfCore(int coreId) { return 1 + coreId % (MAX_SHARDS - 1); }
+
+    CounterShard& local() { return shards[threadShard]; }
+
+    // Called by a core thread right after pinning and binding: the first write to the
+    // shard's page comes from the core itself, so the page is allocated on its node.
+    // Pages already written earlier in the run (a previous start, a restore) stay put.
+    void claimLocal() { local().activeTicks.fetch_add(0, std::memory_order_relaxed); }
+
+    void add(std::atomic<long> CounterShard::*field, long delta) {
+        (local().*field).fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void addForCore(int coreId, std::atomic<long> CounterShard::*field, long delta) {
+        (shards[1 + coreId % (MAX_SHARDS - 1)].*field).fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void stateChanged(int from, int to) {
+        CounterShard& s = local();
+        if (from >= 0) s.inState[from].fetch_sub(1, std::memory_order_relaxed);
+        if (to >= 0) s.inState[to].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    long activeTicks() const { return total(&CounterShard::activeTicks); }
+    long idleTicks() const { return total(&CounterShard::idleTicks); }
+    long memoryUsed() const { return total(&CounterShard::memoryUsed); }
+    long pagedIn() const { return total(&CounterShard::pagedIn); }
+    long pagedOut() const { return total(&CounterShard::pagedOut); }
+
+    // Event counters only: memory, paging and state counts are rebuilt from the
+    // restored processes when they are registered.
+    void saveState(CheckpointWriter& w) const {
+        for (const auto& s : shards) {
+            w.i64(s.activeTicks.load());
+            w.i64(s.idleTicks.load());
+            w.i64(s.instructions.load());
+            w.i64(s.pageFaults.load());
+            w.i64(s.contextSwitches.load());
+        }
+    }
+
+    void restoreState(CheckpointReader& r) {
+        for (auto& s : shards) {
+            s.activeTicks.store(r.i64());
+            s.idleTicks.store(r.i64());
+            s.instructions.store(r.i64());
+            s.pageFaults.store(r.i64());
+            s.contextSwitches.store(r.i64());
+        }
+    }
+
+    // Commits event counters staged by restoreState on a scratch instance.
+    void copyEventsFrom(const CoreCounters& other) {
+        for (int i = 0; i < MAX_SHARDS; ++i) {
+            const CounterShard& from = other.shards[i];
+            CounterShard& to = shards[i];
+            to.activeTicks.store(from.activeTicks.load());
+            to.idleTicks.store(from.idleTicks.load());
+            to.instructions.store(from.instructions.load());
+            to.pageFaults.store(from.pageFaults.load());
+            to.contextSwitches.store(from.contextSwitches.load());
+        }
+    }
+
+    long countInState(int state) const {
+        long sum = 0;
+        for (const auto& s : shards) sum += s.inState[state].load(std::memory_order_relaxed);
+        return sum;
+    }
+};
+
+extern CoreCounters coreCounters;
@@ -17,10 +17,10 @@ static std::string trim(const std::string& s) {
     return s.substr(start, end - start + 1);
 }
 
-void Instruction::execute(Process* process) {
-    extern std::atomic<long> activeTicks;
-    activeTicks++; 
+bool Instruction::execute(Process* process) const {
+    coreCounters.add(&CounterShard::instructions, 1);
     std::string params = trim(parameters);
+    bool faulted = false;
 
     try {
         switch (type) {
@@ -43,13 +43,13 @@ void Instruction::execute(Process* process) {
                 }
             }
 
-            process->logs.push_back("PRINT: " + output);
+            process->appendLog("PRINT: " + output);
             break;
         }
 
         case Type::DECLARE: {
             if (process->symbolTable.size() >= 32) {
-                process->logs.push_back("Symbol table full. DECLARE ignored.");
+                process->appendLog("Symbol table full. DECLARE ignored.");
                 break;
             }
 
@@ -88,7 +88,7 @@ void Instruction::execute(Process* process) {
             if (!memmgr.validAddress(addr))
                 throw std::runtime_error("Invalid memory READ address");
 
-            uint16_t val = memmgr.read(process, addr);
+            uint16_t val = memmgr.read(process, addr, &faulted);
             process->symbolTable[var] = val;
 
             // Track paging
@@ -112,7 +112,7 @@ void Instruction::execute(Process* process) {
             else
                 value = std::clamp(std::stoi(valueStr), 0, 65535);
 
-            memmgr.write(process,addr, value);
+            memmgr.write(process,addr, value, &faulted);
 
             // Track paging
             process->incrementPagedOut();
@@ -120,9 +120,11 @@ void Instruction::execute(Process* process) {
         }
 
 
-        case Type::SLEEP:
-            std::this_thread::sleep_for(std::chrono::milliseconds(std::stoi(params)));
+        case Type::SLEEP: {
+            int ticks = std::stoi(params);
+            if (ticks > 0) process->block(Suspend::SLEEP, ticks);
             break;
+        }
 
         case Type::FOR:
             
@@ -132,11 +134,12 @@ void Instruction::execute(Process* process) {
             break;
         }
     } catch (std::exception& e) {
-        process->logs.push_back(std::string("Error: ") + e.what() + " at: " + parameters);
-        process->state = ProcessState::FINISHED;
+        process->appendLog(std::string("Error: ") + e.what() + " at: " + parameters);
+        process->setState(ProcessState::FINISHED);
     } catch (...) {
-        process->logs.push_back("Unknown error at: " + parameters);
-        process->state = ProcessState::FINISHED;
+        process->appendLog("Unknown error at: " + parameters);
+        process->setState(ProcessState::FINISHED);
     }
+    return faulted;
 }
 
@@ -14,10 +14,12 @@ public:
     std::string parameters;
 
     Instruction() : type(Type::UNKNOWN) {}
-    Instruction(Type t, const std::string& params) : type(t), parameters(params) {}
+    Instruction(Type t, std::string params) : type(t), parameters(std::move(params)) {}
     Instruction(const std::string& instrStr) { *this = fromString(instrStr); }
 
-    void execute(Process* process);
+    // Returns true if the instruction took a page fault (a READ or WRITE of a
+    // non-resident page); hits on resident pages return false.
+    bool execute(Process* process) const;
 
     static std::string trim(const std::string& str) {
         size_t first = str.find_first_not_of(" \t\n\r");
@@ -34,14 +36,14 @@ public:
         std::getline(iss, params);
         params = trim(params);
 
-        if (cmd == "DECLARE") return Instruction(Type::DECLARE, params);
-        if (cmd == "ADD") return Instruction(Type::ADD, params);
-        if (cmd == "SUB") return Instruction(Type::SUB, params);
-        if (cmd == "READ") return Instruction(Type::READ, params);
-        if (cmd == "WRITE") return Instruction(Type::WRITE, params);
-        if (cmd == "PRINT") return Instruction(Type::PRINT, params);
-        if (cmd == "SLEEP") return Instruction(Type::SLEEP, params);
-        if (cmd == "FOR") return Instruction(Type::FOR, params);
+        if (cmd == "DECLARE") return Instruction(Type::DECLARE, std::move(params));
+        if (cmd == "ADD") return Instruction(Type::ADD, std::move(params));
+        if (cmd == "SUB") return Instruction(Type::SUB, std::move(params));
+        if (cmd == "READ") return Instruction(Type::READ, std::move(params));
+        if (cmd == "WRITE") return Instruction(Type::WRITE, std::move(params));
+        if (cmd == "PRINT") return Instruction(Type::PRINT, std::move(params));
+        if (cmd == "SLEEP") return Instruction(Type::SLEEP, std::move(params));
+        if (cmd == "FOR") return Instruction(Type::FOR, std::move(params));
 
         throw std::runtime_error("Unknown instruction: " + cmd);
     }
@@ -5,10 +5,15 @@
 #include <string>
 #include <mutex>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
 #include "Process.h"
+#include "Tracer.h"
+#include "AsyncWriter.h"
 
 struct MemoryPage {
     std::string processName;
@@ -20,18 +25,49 @@ class MemoryManager {
 private:
     bool loggingEnabled = true;
     size_t maxFrames;
+    int frameBytes = 64;                     // mem-per-frame
+    std::atomic<size_t> committedFrames{0};  // promised to admitted processes, see reserve
     std::deque<MemoryPage> frames; // FIFO
+    std::atomic<size_t> residentFrames{0};   // frames.size(), readable without mtx
     std::unordered_map<std::string, std::unordered_map<uint16_t, uint16_t>> backingStore;
     mutable std::mutex mtx;
 
 public:
     MemoryManager(size_t frames_ = 64) : maxFrames(frames_) {}
 
-    bool canAllocate(const std::string &procName, int kb) {
+    // Sizes physical memory from the config: max-overall-mem / mem-per-frame frames.
+    void configure(size_t totalFrames, int frameSize) {
         std::lock_guard<std::mutex> lock(mtx);
-        return (frames.size() + kb) <= maxFrames;
+        maxFrames = std::max<size_t>(1, totalFrames);
+        frameBytes = std::max(1, frameSize);
     }
 
+    size_t framesFor(int memSize) const { return (memSize + frameBytes - 1) / frameBytes; }
+
+    // Admission check: would a process declaring `kb` fit next to `committed` frames
+    // already promised to admitted processes? With nothing admitted it always fits,
+    // so a process larger than physical memory cannot starve.
+    bool canAllocate(int kb, size_t committed) const {
+        return committed == 0 || committed + framesFor(kb) <= maxFrames;
+    }
+
+    // Commits `kb` worth of frames if canAllocate approves them against the current
+    // commitment; `force` skips the check (restored processes).
+    bool reserve(int kb, bool force = false) {
+        size_t need = framesFor(kb);
+        size_t committed = committedFrames.load(std::memory_order_relaxed);
+        do {
+            if (!force && !canAllocate(kb, committed)) return false;
+        } while (!committedFrames.compare_exchange_weak(committed, committed + need, std::memory_order_relaxed));
+        return true;
+    }
+
+    void unreserve(int kb) {
+        committedFrames.fetch_sub(framesFor(kb), std::memory_order_relaxed);
+    }
+
+    size_t getCommittedFrames() const { return committedFrames.load(std::memory_order_relaxed); }
+
     void disableLogging() {
         std::lock_guard<std::mutex> lock(mtx);
         loggingEnabled = false;
@@ -42,9 +78,11 @@ public:
         loggingEnabled = true;
     }
 
-    void write(Process* proc, uint16_t addr, uint16_t value) {
+    // `faulted`, if given, is set when the page was not resident and had to be faulted in.
+    void write(Process* proc, uint16_t addr, uint16_t value, bool* faulted = nullptr) {
         std::lock_guard<std::mutex> lock(mtx);
         MemoryPage* page = findPage(proc->getProcessName(), addr);
+        if (faulted) *faulted = !page;
         if (!page) {
             pageFault(proc, addr, true);
             page = findPage(proc->getProcessName(), addr);
@@ -53,9 +91,10 @@ public:
         page->value = value;
     }
 
-    uint16_t read(Process* proc, uint16_t addr) {
+    uint16_t read(Process* proc, uint16_t addr, bool* faulted = nullptr) {
         std::lock_guard<std::mutex> lock(mtx);
         MemoryPage* page = findPage(proc->getProcessName(), addr);
+        if (faulted) *faulted = !page;
         if (!page) {
             pageFault(proc, addr, false);
             page = findPage(proc->getProcessName(), addr);
@@ -69,19 +108,100 @@ public:
         return frames.size();
     }
 
+    // Lock-free reads for background samplers.
+    size_t peekUsedFrames() const { return residentFrames.load(std::memory_order_relaxed); }
+    size_t getTotalFrames() const { return maxFrames; }
+
     bool validAddress(uint16_t addr) const {
         return addr <= 0xFFFF;
     }
 
-    void dumpBackingStore(const std::string &filename = "backing_store.txt") {
+    // Empties every frame and the backing store (between benchmark runs).
+    void reset() {
         std::lock_guard<std::mutex> lock(mtx);
-        std::ofstream ofs(filename);
-        for (auto &procPair : backingStore) {
+        frames.clear();
+        backingStore.clear();
+        residentFrames.store(0, std::memory_order_relaxed);
+        committedFrames.store(0, std::memory_order_relaxed);
+    }
+
+    // Drops a finished process's resident pages and backing-store entries.
+    void releaseProcess(const std::string &procName) {
+        std::lock_guard<std::mutex> lock(mtx);
+        frames.erase(std::remove_if(frames.begin(), frames.end(),
+            [&procName](const MemoryPage &f) { return f.processName == procName; }), frames.end());
+        residentFrames.store(frames.size(), std::memory_order_relaxed);
+        backingStore.erase(procName);
+    }
+
+    // Frames in FIFO order, then the backing store.
+    void saveState(CheckpointWriter& w) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        w.u64(maxFrames);
+        w.u32(static_cast<uint32_t>(frames.size()));
+        for (const auto& f : frames) {
+            w.str(f.processName);
+            w.u32(f.address);
+            w.u32(f.value);
+        }
+        w.u32(static_cast<uint32_t>(backingStore.size()));
+        for (const auto& [procName, pages] : backingStore) {
+            w.str(procName);
+            w.u32(static_cast<uint32_t>(pages.size()));
+            for (const auto& [addr, value] : pages) {
+                w.u32(addr);
+                w.u32(value);
+            }
+        }
+    }
+
+    void restoreState(CheckpointReader& r) {
+        std::lock_guard<std::mutex> lock(mtx);
+        maxFrames = r.u64();
+        frames.clear();
+        backingStore.clear();
+        uint32_t resident = r.count(12);   // name length + address + value
+        for (uint32_t i = 0; i < resident; ++i) {
+            std::string procName = r.str();
+            uint16_t addr = static_cast<uint16_t>(r.u32());
+            uint16_t value = static_cast<uint16_t>(r.u32());
+            frames.push_back({ procName, addr, value });
+        }
+        uint32_t procs = r.count(8);   // name length + page count
+        for (uint32_t i = 0; i < procs; ++i) {
+            auto& pages = backingStore[r.str()];
+            uint32_t n = r.count(8);
+            for (uint32_t k = 0; k < n; ++k) {
+                uint16_t addr = static_cast<uint16_t>(r.u32());
+                pages[addr] = static_cast<uint16_t>(r.u32());
+            }
+        }
+        residentFrames.store(frames.size(), std::memory_order_relaxed);
+    }
+
+    // Commits pager state staged by restoreState on a scratch instance.
+    void takeStateFrom(MemoryManager& other) {
+        std::scoped_lock lock(mtx, other.mtx);
+        maxFrames = other.maxFrames;
+        frames.swap(other.frames);
+        backingStore.swap(other.backingStore);
+        residentFrames.store(frames.size(), std::memory_order_relaxed);
+    }
+
+    // Only the copy happens under the lock; formatting and I/O run without stalling the cores.
+    void dumpBackingStore(const std::string &filename = "backing_store.txt") {
+        std::unordered_map<std::string, std::unordered_map<uint16_t, uint16_t>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            snapshot = backingStore;
+        }
+        std::ostringstream ofs;
+        for (auto &procPair : snapshot) {
             ofs << "Process: " << procPair.first << "\n";
             for (auto &addrVal : procPair.second)
                 ofs << "  0x" << std::hex << addrVal.first << ": " << std::dec << addrVal.second << "\n";
         }
-        ofs.close();
+        fileWriter.submit(filename, ofs.str());
     }
 
 private:
@@ -94,6 +214,7 @@ private:
     }
 
     void pageFault(Process* proc, uint16_t addr, bool isWrite) {
+    uint64_t startNs = perfStats.enabled() ? PerfStats::nowNs() : 0;
     if (loggingEnabled) {
         /*std::cout << "[MEM] Page fault: " << proc->getProcessName()
                   << " accessing 0x" << std::hex << addr
@@ -101,6 +222,8 @@ private:
     }
 
     
+    coreCounters.add(&CounterShard::pageFaults, 1);
+    if (tracer.active()) tracer.record(Tracer::EventType::PAGE_FAULT, proc, addr);
     if (isWrite) proc->incrementPagedOut();
     else proc->incrementPagedIn();
 
@@ -120,6 +243,8 @@ private:
     }
 
     frames.push_back({proc->getProcessName(), addr, value});
+    residentFrames.store(frames.size(), std::memory_order_relaxed);
+    if (startNs) perfStats.record(PerfStats::PAGE_FAULT, PerfStats::nowNs() - startNs);
 }
 
 };
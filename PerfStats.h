@@ -0,0 +1,229 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+#include <stdexcept>
+#include "CoreCounters.h"
+#include "globals.h"
+
+// Log-linear latency histogram in the style of HdrHistogram: values are grouped by
+// power of two and each power is split into SUB_BUCKETS linear steps, so every
+// bucket is within 1/SUB_BUCKETS of the values it holds, from 1 ns to ~hours.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAGNITUDES = 40;
+    static constexpr int BUCKETS = MAGNITUDES * SUB_BUCKETS;
+
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+
+    static int bucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS) return static_cast<int>(v);
+        int msb = 63 - __builtin_clzll(v);
+        int magnitude = msb - SUB_BITS + 1;
+        if (magnitude >= MAGNITUDES) return BUCKETS - 1;
+        int sub = static_cast<int>((v >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+        return magnitude * SUB_BUCKETS + sub;
+    }
+
+    // Smallest value that lands in bucket b.
+    static uint64_t bucketLow(int b) {
+        int magnitude = b / SUB_BUCKETS, sub = b % SUB_BUCKETS;
+        if (magnitude == 0) return sub;
+        return static_cast<uint64_t>(SUB_BUCKETS + sub) << (magnitude - 1);
+    }
+    static uint64_t bucketHigh(int b) {
+        return b + 1 < BUCKETS ? bucketLow(b + 1) - 1 : UINT64_MAX;
+    }
+
+    void record(uint64_t v) {
+        counts[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(v, std::memory_order_relaxed);
+        uint64_t seen = max.load(std::memory_order_relaxed);
+        while (v > seen && !max.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {}
+    }
+
+    void clear() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+};
+
+// A histogram merged from several shards, for reporting.
+struct LatencySummary {
+    std::vector<uint64_t> counts = std::vector<uint64_t>(LatencyHistogram::BUCKETS, 0);
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    void add(const LatencyHistogram& h) {
+        for (int b = 0; b < LatencyHistogram::BUCKETS; ++b)
+            counts[b] += h.counts[b].load(std::memory_order_relaxed);
+        count += h.count.load(std::memory_order_relaxed);
+        sum += h.sum.load(std::memory_order_relaxed);
+        max = std::max(max, h.max.load(std::memory_order_relaxed));
+    }
+
+    // Upper bound of the bucket holding the p-th value, as HdrHistogram reports it.
+    uint64_t percentile(double p) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p * count);
+        if (rank >= count) rank = count - 1;
+        uint64_t seen = 0;
+        for (int b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen > rank) return std::min(LatencyHistogram::bucketHigh(b), max);
+        }
+        return max;
+    }
+};
+
+// Optional hot-path instrumentation: per-opcode execute latency, page-fault service
+// time and READY->RUNNING dispatch latency. Every thread records into its own
+// CoreCounters shard without locks; shards are allocated on first use, so nothing
+// is paid while it is off beyond one relaxed load per instruction.
+class PerfStats {
+public:
+    // Metrics 0..8 follow Instruction::Type.
+    static constexpr int OPCODES = 9;
+    static constexpr int PAGE_FAULT = OPCODES;
+    static constexpr int DISPATCH = OPCODES + 1;
+    static constexpr int METRICS = OPCODES + 2;
+
+    struct Shard {
+        LatencyHistogram metrics[METRICS];
+    };
+
+private:
+    std::atomic<bool> on{false};
+    std::atomic<Shard*> shards[CoreCounters::MAX_SHARDS] = {};
+
+    Shard* shardAt(int index) {
+        Shard* s = shards[index].load(std::memory_order_acquire);
+        if (s) return s;
+        Shard* fresh = new Shard();
+        if (shards[index].compare_exchange_strong(s, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;
+        return s;
+    }
+
+public:
+    PerfStats() = default;
+    PerfStats(const PerfStats&) = delete;
+    PerfStats& operator=(const PerfStats&) = delete;
+    ~PerfStats() {
+        for (auto& s : shards) delete s.load();
+    }
+
+    static const char* metricName(int metric) {
+        static const char* names[METRICS] = {
+            "DECLARE", "ADD", "SUB", "READ", "WRITE", "PRINT", "SLEEP", "FOR", "UNKNOWN",
+            "page-fault", "dispatch"
+        };
+        return names[metric];
+    }
+
+    bool enabled() const { return on.load(std::memory_order_relaxed); }
+    void setEnabled(bool enable) { on.store(enable, std::memory_order_relaxed); }
+
+    static uint64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Dispatch latency is scheduler time: simulated ms in virtual mode, host time otherwise.
+    static uint64_t dispatchClockNs() {
+        if (virtualTime) return static_cast<uint64_t>(simTick.load(std::memory_order_relaxed)) * 1000000;
+        return nowNs();
+    }
+
+    void record(int metric, uint64_t ns) {
+        shardAt(CoreCounters::currentShard())->metrics[metric].record(ns);
+    }
+
+    void reset() {
+        for (auto& s : shards) {
+            if (Shard* shard = s.load(std::memory_order_acquire))
+                for (auto& h : shard->metrics) h.clear();
+        }
+    }
+
+    // coreId -1 merges every shard, including non-core threads (REPL, generator).
+    LatencySummary summary(int metric, int coreId = -1) const {
+        LatencySummary out;
+        for (int i = 0; i < CoreCounters::MAX_SHARDS; ++i) {
+            if (coreId >= 0 && i != CoreCounters::shardOfCore(coreId)) continue;
+            if (Shard* shard = shards[i].load(std::memory_order_acquire))
+                out.add(shard->metrics[metric]);
+        }
+        return out;
+    }
+
+    void print(std::ostream& os, int numCores) const {
+        os << "Hot-path latency (ns" << (virtualTime ? "; dispatch in simulated ns" : "") << ")"
+           << (enabled() ? "" : " [recording off]") << "\n";
+        os << std::left << std::setw(12) << "metric" << std::right
+           << std::setw(12) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+           << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+           << std::setw(12) << "max" << "\n";
+        for (int m = 0; m < METRICS; ++m) {
+            LatencySummary s = summary(m);
+            if (s.count == 0) continue;
+            printRow(os, metricName(m), s);
+        }
+
+        os << "\nPer core (dispatch / page-fault p99, instructions timed):\n";
+        for (int c = 0; c < numCores; ++c) {
+            uint64_t timed = 0;
+            for (int m = 0; m < OPCODES; ++m) timed += summary(m, c).count;
+            os << " Core " << c << ": dispatch p99 " << summary(DISPATCH, c).percentile(0.99)
+               << " | page-fault p99 " << summary(PAGE_FAULT, c).percentile(0.99)
+               << " | " << timed << "\n";
+        }
+    }
+
+    // Full per-core bucket listing, for offline analysis.
+    void dump(const std::string& filename, int numCores) const {
+        std::ofstream ofs(filename);
+        if (!ofs.is_open()) throw std::runtime_error("Unable to open file: " + filename);
+        print(ofs, numCores);
+        ofs << "\n# shard metric bucket_low_ns bucket_high_ns count\n";
+        for (int i = 0; i < CoreCounters::MAX_SHARDS; ++i) {
+            Shard* shard = shards[i].load(std::memory_order_acquire);
+            if (!shard) continue;
+            std::string who = i == 0 ? "other" : "core" + std::to_string(i - 1);
+            for (int m = 0; m < METRICS; ++m) {
+                const LatencyHistogram& h = shard->metrics[m];
+                for (int b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                    uint64_t n = h.counts[b].load(std::memory_order_relaxed);
+                    if (n == 0) continue;
+                    ofs << who << " " << metricName(m) << " " << LatencyHistogram::bucketLow(b)
+                        << " " << LatencyHistogram::bucketHigh(b) << " " << n << "\n";
+                }
+            }
+        }
+    }
+
+private:
+    static void printRow(std::ostream& os, const std::string& name, const LatencySummary& s) {
+        os << std::left << std::setw(12) << name << std::right
+           << std::setw(12) << s.count << std::setw(10) << s.sum / s.count
+           << std::setw(10) << s.percentile(0.50) << std::setw(10) << s.percentile(0.90)
+           << std::setw(10) << s.percentile(0.99) << std::setw(10) << s.percentile(0.999)
+           << std::setw(12) << s.max << "\n";
+    }
+};
+
+extern PerfStats perfStats;
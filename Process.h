@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
 #include <chrono>
 #include <ctime>
 #include <sstream>
@@ -11,169 +12,563 @@
 #include <stdexcept>
 #include "Instruction.h"
 #include "globals.h"
+#include "SeqLock.h"
+#include "CoreCounters.h"
+#include "PerfStats.h"
+#include "CheckpointIO.h"
+#include "ProcessTable.h"
 #include <atomic>
+#include <mutex>
+#include <fstream>
 
 
 enum class ProcessState {
     READY,
     RUNNING,
+    WAITING,
     FINISHED
 };
 
+// Why executing a process stopped. A process is a resumable state machine: a core runs
+// it one instruction at a time and gives it up at the first reason other than NONE,
+// so a blocked process never holds a core thread.
+enum class Suspend {
+    NONE,         // keep running
+    QUANTUM,      // round-robin slice used up (decided by the scheduler)
+    SLEEP,        // SLEEP instruction; resumed by the timer wheel
+    PAGE_FAULT,   // a READ/WRITE missed a resident page; blocks only if page-fault-ticks models disk I/O
+    FINISHED
+};
+// Admission is deliberately not a reason here: a process that does not fit in memory
+// never reaches a core. It waits in the Scheduler's admission queue before its first
+// step, so there is no running process to suspend.
+
+// Consistent copy of the fields monitoring commands display.
+struct ProcessSnapshot {
+    ProcessState state;
+    int currentLine;
+    int lineCount;
+    int memoryUsed;
+    int core;
+    int pagedIn;
+    int pagedOut;
+};
+
+// A process's log lines. Once the process is reaped they are spilled to a file and
+// only the path is kept; readers get the same lines either way.
+class LogBook {
+private:
+    std::vector<std::string> lines;
+    std::string archivePath;
+    mutable std::mutex mtx;
+
+public:
+    LogBook() = default;
+    LogBook(const LogBook& other) {
+        std::lock_guard<std::mutex> lock(other.mtx);
+        lines = other.lines;
+        archivePath = other.archivePath;
+    }
+    LogBook& operator=(const LogBook& other) {
+        if (this == &other) return *this;
+        std::scoped_lock lock(mtx, other.mtx);
+        lines = other.lines;
+        archivePath = other.archivePath;
+        return *this;
+    }
+
+    void append(std::string line) {
+        std::lock_guard<std::mutex> lock(mtx);
+        lines.push_back(std::move(line));
+    }
+
+    std::string last() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return lines.empty() ? "" : lines.back();
+    }
+
+    std::vector<std::string> read() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (archivePath.empty()) return lines;
+
+        std::vector<std::string> fromDisk;
+        std::ifstream in(archivePath);
+        std::string line;
+        while (std::getline(in, line)) fromDisk.push_back(line);
+        return fromDisk;
+    }
+
+    // Writes `header` and every line to `path`, then drops the in-memory copy.
+    bool spill(const std::string& path, const std::string& header) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::ofstream out(path);
+        if (!out.is_open()) return false;
+        out << header;
+        for (const auto& line : lines) out << line << "\n";
+        out.close();
+        std::vector<std::string>().swap(lines);
+        archivePath = path;
+        return true;
+    }
+
+    bool isArchived() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return !archivePath.empty();
+    }
+
+    void saveState(CheckpointWriter& w) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        w.str(archivePath);
+        w.u32(static_cast<uint32_t>(lines.size()));
+        for (const auto& line : lines) w.str(line);
+    }
+
+    void restoreState(CheckpointReader& r) {
+        std::lock_guard<std::mutex> lock(mtx);
+        archivePath = r.str();
+        lines.resize(r.count(4));   // a line is at least its u32 length
+        for (auto& line : lines) line = r.str();
+    }
+};
+
 class Process {
 private:
     int memorySize;
-    int memoryUsed = 0;
-    int peakMemoryUsed = 0;
+    SeqField<int> memoryUsed = 0;
+    SeqField<int> peakMemoryUsed = 0;
     int id;
     std::string name;
-    std::vector<Instruction> instructions;
-    int currentInstructionIndex = 0;
+    // Immutable once built, so generated processes can share one program template.
+    std::shared_ptr<const std::vector<Instruction>> program;
+    int lineCount = 0;      // kept after the program is released by the reaper
+    SeqField<int> currentInstructionIndex = 0;
     int totalLinesOfCode = 0;
-    int pagedInCount = 0;
-    int pagedOutCount = 0;
-    int currentCore = -1; 
+    SeqField<int> pagedInCount = 0;
+    SeqField<int> pagedOutCount = 0;
+    SeqField<int> currentCore = -1; 
+    int sleepTicks = 0;
+    // Guards multi-field updates so snapshot() never sees e.g. a new line with a stale state.
+    SeqLock seq;
+    SeqField<ProcessState> state;
+    bool tracked = false;   // counted in coreCounters once registered
+    ProcessTable* table = nullptr;   // registry's monitoring columns, mirrored once registered
+    size_t slot = 0;
+    bool admitted = false;  // holds a memory reservation (Scheduler admission control)
+    std::chrono::system_clock::time_point createdAt = std::chrono::system_clock::now();
+    SeqField<long long> finishedAtMs = 0;   // ms since epoch, 0 while still live
+    // Scheduler-clock times (see schedulerClockMs) for turnaround and waiting time.
+    long long createdClock = schedulerClockMs();
+    SeqField<long long> finishedClock = 0;
+    SeqField<long long> readySinceClock = createdClock;
+    SeqField<long long> waitedMs = 0;
+    uint64_t readySinceNs = 0;   // only stamped while perfStats is on
+    LogBook logs;
     
 
+    // Thread-safe std::localtime; the reaper and every core format times concurrently.
+    static std::tm localTime(std::time_t t) {
+        std::tm local;
+#ifdef _WIN32
+        localtime_s(&local, &t);
+#else
+        localtime_r(&t, &local);
+#endif
+        return local;
+    }
+
+    static std::string formatTime(std::chrono::system_clock::time_point t) {
+        std::tm local = localTime(std::chrono::system_clock::to_time_t(t));
+        std::ostringstream out;
+        out << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
+        return out.str();
+    }
+
+    // Formatted at most once per second per thread; every log line and creation needs one.
     std::string getCurrentTimestamp() const {
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-        std::ostringstream timestamp;
-        timestamp << "[" << std::put_time(std::localtime(&now_time), "%Y-%m-%d %H:%M:%S") << "]";
-        return timestamp.str();
+        static thread_local std::time_t cachedTime = -1;
+        static thread_local std::string cached;
+        std::time_t now_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (now_time != cachedTime) {
+            std::tm local = localTime(now_time);
+            std::ostringstream timestamp;
+            timestamp << "[" << std::put_time(&local, "%Y-%m-%d %H:%M:%S") << "]";
+            cached = timestamp.str();
+            cachedTime = now_time;
+        }
+        return cached;
     }
 
     void calculateTotalLines() {
-        totalLinesOfCode = 0;
-        for (const auto& instr : instructions) {
-            if (instr.type == Instruction::Type::FOR) {
-                try {
-                    int loopCount = std::stoi(instr.parameters);
-                    totalLinesOfCode += loopCount;
-                } catch (...) { totalLinesOfCode++; }
-            } else totalLinesOfCode++;
-        }
+        totalLinesOfCode = program ? countTotalLines(*program) : 0;
     }
 
     void updatePeakMemory() {
-        if (memoryUsed > peakMemoryUsed) peakMemoryUsed = memoryUsed;
+        if (memoryUsed > peakMemoryUsed) peakMemoryUsed = memoryUsed.load();
+    }
+
+    // Every state change goes through here so the global per-state counts stay exact.
+    void moveTo(ProcessState to) {
+        ProcessState from = state;
+        if (from == to) return;
+        state = to;
+        if (to == ProcessState::READY) {
+            readySinceClock = schedulerClockMs();
+            readySinceNs = perfStats.enabled() ? PerfStats::dispatchClockNs() : 0;
+        } else if (from == ProcessState::READY && to == ProcessState::RUNNING) {
+            waitedMs += schedulerClockMs() - readySinceClock;
+            if (readySinceNs && perfStats.enabled())
+                perfStats.record(PerfStats::DISPATCH, PerfStats::dispatchClockNs() - readySinceNs);
+        } else if (to == ProcessState::FINISHED) {
+            finishedClock = schedulerClockMs();
+            finishedAtMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        if (tracked) coreCounters.stateChanged(static_cast<int>(from), static_cast<int>(to));
+        if (table) table->setState(slot, static_cast<int>(to));
     }
 
 public:
-    void setCurrentCore(int core) { currentCore = core; }
+    void setCurrentCore(int core) {
+        seq.writeBegin();
+        currentCore = core;
+        seq.writeEnd();
+        if (table) table->setCore(slot, core);
+    }
     int getCurrentCore() const { return currentCore; }
 
-    std::vector<std::string> logs;
-    ProcessState state;
     std::unordered_map<std::string, int> symbolTable;
     bool isScreened = false;
 
     void markScreened() { isScreened = true; }
-    const std::vector<std::string>& getLogs() const { return logs; }
+    void appendLog(std::string line) { logs.append(std::move(line)); }
+    std::string getLastLog() const { return logs.last(); }
+    // In-memory lines while live, the spilled file once archived.
+    std::vector<std::string> getLogs() const { return logs.read(); }
+    bool isArchived() const { return logs.isArchived(); }
 
-    void incrementPagedIn() { pagedInCount++; }
-    void incrementPagedOut() { pagedOutCount++; }
+    // Reaper only: the process is FINISHED and off every core. Spills the logs to `path`
+    // and frees the instructions and symbol table, leaving a small summary record.
+    bool archive(const std::string& path) {
+        std::ostringstream header;
+        header << "Process: " << name << "\n"
+               << "PID: " << id << "\n"
+               << "Lines: " << currentInstructionIndex << "/" << lineCount << "\n"
+               << "Created: " << formatTime(createdAt) << "\n"
+               << "Finished: " << formatTime(std::chrono::system_clock::time_point(
+                      std::chrono::milliseconds(finishedAtMs.load()))) << "\n"
+               << "Page faults: " << (pagedInCount + pagedOutCount) << "\n"
+               << "--- logs ---\n";
+        if (!logs.spill(path, header.str())) return false;
+
+        program.reset();
+        std::unordered_map<std::string, int>().swap(symbolTable);
+        return true;
+    }
+
+    // Once the process has FINISHED and left the core its variables are dead; free them
+    // now rather than holding them until the reaper archives the process.
+    void releaseVariables() {
+        std::unordered_map<std::string, int>().swap(symbolTable);
+    }
+
+    void incrementPagedIn() {
+        pagedInCount++;
+        if (tracked) coreCounters.add(&CounterShard::pagedIn, 1);
+    }
+    void incrementPagedOut() {
+        pagedOutCount++;
+        if (tracked) coreCounters.add(&CounterShard::pagedOut, 1);
+    }
+
+    // Called once when the process enters the registry at `pos`; from then on it feeds
+    // coreCounters and its row of the registry's ProcessTable.
+    void startTracking(ProcessTable& t, size_t pos) {
+        tracked = true;
+        table = &t;
+        slot = pos;
+        t.attach(pos, static_cast<int>(state.load()), currentInstructionIndex, lineCount, memoryUsed, currentCore);
+        coreCounters.stateChanged(-1, static_cast<int>(state.load()));
+        coreCounters.add(&CounterShard::memoryUsed, memoryUsed);
+        coreCounters.add(&CounterShard::pagedIn, pagedInCount);
+        coreCounters.add(&CounterShard::pagedOut, pagedOutCount);
+    }
     int getPagedIn() const { return pagedInCount; }
     int getPagedOut() const { return pagedOutCount; }
 
+    // Parks the process for `ticks` instead of blocking the core; the scheduler picks up
+    // the ticks. SLEEP and a PAGE_FAULT waiting on the backing store take the same timer
+    // path. Returns `why` so a caller can pass the reason straight on.
+    Suspend block(Suspend why, int ticks) {
+        sleepTicks = ticks;
+        moveTo(ProcessState::WAITING);
+        return why;
+    }
+    int takeSleepTicks() {
+        int ticks = sleepTicks;
+        sleepTicks = 0;
+        return ticks;
+    }
+
+    // Used outside the scheduler (screen -c), where the caller owns the thread and can simply block.
+    void sleepInline() {
+        if (state != ProcessState::WAITING) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(takeSleepTicks()));
+        moveTo(ProcessState::RUNNING);
+    }
+
+    int getMemorySize() const { return memorySize; }
+    bool isAdmitted() const { return admitted; }
+    void setAdmitted(bool value) { admitted = value; }
+
     int getMemoryUsed() const { return memoryUsed; }
     double getMemoryUsedMiB() const { return static_cast<double>(memoryUsed) / 1024.0; }
     double getPeakMemoryUsedMiB() const { return static_cast<double>(peakMemoryUsed) / 1024.0; }
 
     void allocateMemory(int kb) {
+        seq.writeBegin();
+        int before = memoryUsed;
         memoryUsed += kb;
         if (memoryUsed > memorySize) memoryUsed = memorySize;
         updatePeakMemory();
+        seq.writeEnd();
+        if (tracked) coreCounters.add(&CounterShard::memoryUsed, memoryUsed - before);
+        if (table) table->setMemoryUsed(slot, memoryUsed);
     }
 
     void freeMemory(int kb) {
+        int before = memoryUsed;
         memoryUsed -= kb;
         if (memoryUsed < 0) memoryUsed = 0;
+        if (tracked) coreCounters.add(&CounterShard::memoryUsed, memoryUsed - before);
+        if (table) table->setMemoryUsed(slot, memoryUsed);
     }
 
     
-    Process(int pid, const std::string& procName, const std::vector<Instruction>& instrs, int memSize = 64)
-        : id(pid), name(procName), instructions(instrs), memorySize(memSize), state(ProcessState::READY)
+    // Processes are built in place (makeProcess) and never copied; pass the instruction
+    // list as an rvalue and it is moved, not copied, into the program.
+    Process(int pid, std::string procName, std::vector<Instruction> instrs, int memSize = 64)
+        : Process(pid, std::move(procName), std::make_shared<const std::vector<Instruction>>(std::move(instrs)), memSize) {}
+
+    static int countTotalLines(const std::vector<Instruction>& instrs) {
+        int total = 0;
+        for (const auto& instr : instrs) {
+            if (instr.type == Instruction::Type::FOR) {
+                try {
+                    total += std::stoi(instr.parameters);
+                } catch (...) { total++; }
+            } else total++;
+        }
+        return total;
+    }
+
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+
+    // Shares `prog` instead of copying it (the generator's template pool). `totalLines` is
+    // countTotalLines(*prog) when the caller already has it, so nothing here walks the program.
+    Process(int pid, std::string procName, std::shared_ptr<const std::vector<Instruction>> prog, int memSize = 64,
+            int totalLines = -1)
+        : memorySize(memSize), id(pid), name(std::move(procName)), program(std::move(prog)), state(ProcessState::READY)
     {
-        if (memSize < 64 || memSize > 216 || (memSize & (memSize - 1)) != 0) {
-            throw std::runtime_error("Invalid memory allocation for process '" + name + "'. Must be power of 2 and 64-216 KiB.");
+        if (memSize < 64 || memSize > 65536 || (memSize & (memSize - 1)) != 0) {
+            throw std::runtime_error("Invalid memory allocation for process '" + name + "'. Must be power of 2 and 64-65536 KiB.");
         }
-        calculateTotalLines();
-        logs.push_back(getCurrentTimestamp() + " Process created with memory " + std::to_string(memorySize) + " KiB.");
+        lineCount = static_cast<int>(programSize());
+        if (totalLines >= 0) totalLinesOfCode = totalLines;
+        else calculateTotalLines();
+        logs.append(getCurrentTimestamp() + " Process created with memory " + std::to_string(memorySize) + " KiB.");
     }
 
-    Process(int pid, const std::string& procName, int memSize, const std::string& instructionsStr)
-        : id(pid), name(procName), memorySize(memSize), state(ProcessState::READY)
+    Process(int pid, std::string procName, int memSize, const std::string& instructionsStr)
+        : id(pid), name(std::move(procName)), memorySize(memSize), state(ProcessState::READY)
     {
-        if (memSize < 64 || memSize > 216 || (memSize & (memSize - 1)) != 0) {
-            throw std::runtime_error("Invalid memory allocation for process '" + name + "'. Must be power of 2 and 64-216 KiB.");
+        if (memSize < 64 || memSize > 65536 || (memSize & (memSize - 1)) != 0) {
+            throw std::runtime_error("Invalid memory allocation for process '" + name + "'. Must be power of 2 and 64-65536 KiB.");
         }
 
+        std::vector<Instruction> instructions;
         std::stringstream ss(instructionsStr);
         std::string instr;
         while (std::getline(ss, instr, ';')) {
             instr = Instruction::trim(instr);
             if (instr.empty()) continue;
-            instructions.push_back(Instruction::fromString(instr));
+            instructions.emplace_back(Instruction::fromString(instr));
         }
 
         if (instructions.empty() || instructions.size() > 50) {
             throw std::runtime_error("Instruction count must be between 1 and 50 for process '" + name + "'.");
         }
 
+        program = std::make_shared<const std::vector<Instruction>>(std::move(instructions));
+        lineCount = static_cast<int>(programSize());
         calculateTotalLines();
-        logs.push_back(getCurrentTimestamp() + " Process created with memory " + std::to_string(memorySize) + " KiB.");
+        logs.append(getCurrentTimestamp() + " Process created with memory " + std::to_string(memorySize) + " KiB.");
+    }
+
+    // Checkpoint image of everything but scheduler placement. Scheduler-clock fields are
+    // stored as-is; the restoring constructor shifts them onto the new clock.
+    void saveState(CheckpointWriter& w, int remainingSleep) const {
+        w.i32(id);
+        w.str(name);
+        w.i32(memorySize);
+        w.i32(memoryUsed);
+        w.i32(peakMemoryUsed);
+        w.i32(lineCount);
+        w.i32(currentInstructionIndex);
+        w.i32(totalLinesOfCode);
+        w.i32(pagedInCount);
+        w.i32(pagedOutCount);
+        w.i32(remainingSleep);
+        w.u8(static_cast<uint8_t>(state.load()));
+        w.u8(isScreened);
+        w.i64(std::chrono::duration_cast<std::chrono::milliseconds>(createdAt.time_since_epoch()).count());
+        w.i64(finishedAtMs);
+        w.i64(createdClock);
+        w.i64(finishedClock);
+        w.i64(readySinceClock);
+        w.i64(waitedMs);
+
+        w.u32(static_cast<uint32_t>(programSize()));
+        for (size_t i = 0; i < programSize(); ++i) {
+            const Instruction& instr = (*program)[i];
+            w.u8(static_cast<uint8_t>(instr.type));
+            w.str(instr.parameters);
+        }
+        w.u32(static_cast<uint32_t>(symbolTable.size()));
+        for (const auto& [var, val] : symbolTable) {
+            w.str(var);
+            w.i32(val);
+        }
+        logs.saveState(w);
+    }
+
+    Process(CheckpointReader& r, long long clockShift) : state(ProcessState::READY) {
+        id = r.i32();
+        name = r.str();
+        memorySize = r.i32();
+        if (memorySize < 64 || memorySize > 65536 || (memorySize & (memorySize - 1)) != 0)
+            throw std::runtime_error("Checkpoint has an invalid memory size for process '" + name + "'.");
+        memoryUsed = r.i32();
+        peakMemoryUsed = r.i32();
+        lineCount = r.i32();
+        currentInstructionIndex = r.i32();
+        totalLinesOfCode = r.i32();
+        pagedInCount = r.i32();
+        pagedOutCount = r.i32();
+        sleepTicks = r.i32();
+        uint8_t savedState = r.u8();
+        if (savedState > static_cast<uint8_t>(ProcessState::FINISHED))
+            throw std::runtime_error("Checkpoint has an invalid state for process '" + name + "'.");
+        // A process that was on a core resumes from the ready queue.
+        state = savedState == static_cast<uint8_t>(ProcessState::RUNNING)
+            ? ProcessState::READY : static_cast<ProcessState>(savedState);
+        isScreened = r.u8() != 0;
+        createdAt = std::chrono::system_clock::time_point(std::chrono::milliseconds(r.i64()));
+        finishedAtMs = r.i64();
+        createdClock = r.i64() + clockShift;
+        long long finished = r.i64();
+        finishedClock = finished > 0 ? finished + clockShift : 0;
+        readySinceClock = r.i64() + clockShift;
+        waitedMs = r.i64();
+
+        std::vector<Instruction> instructions(r.count(5));   // u8 type + u32 length
+        for (auto& instr : instructions) {
+            uint8_t type = r.u8();
+            instr.type = type < static_cast<uint8_t>(Instruction::Type::UNKNOWN)
+                ? static_cast<Instruction::Type>(type) : Instruction::Type::UNKNOWN;
+            instr.parameters = r.str();
+        }
+        if (!instructions.empty()) program = std::make_shared<const std::vector<Instruction>>(std::move(instructions));
+        uint32_t vars = r.count(8);   // u32 length + i32 value
+        for (uint32_t i = 0; i < vars; ++i) {
+            std::string var = r.str();
+            symbolTable[var] = r.i32();
+        }
+        logs.restoreState(r);
     }
 
     
     int getPid() const { return id; }
     std::string getProcessName() const { return name; }
     ProcessState getState() const { return state; }
-    void setState(ProcessState newState) { state = newState; }
+    void setState(ProcessState newState) {
+        seq.writeBegin();
+        moveTo(newState);
+        seq.writeEnd();
+    }
+
+    // Lock-free for both sides: the executing core never waits for a reader.
+    ProcessSnapshot snapshot() const {
+        ProcessSnapshot s;
+        seq.read([&]() {
+            s.state = state;
+            s.currentLine = currentInstructionIndex;
+            s.memoryUsed = memoryUsed;
+            s.core = currentCore;
+            s.pagedIn = pagedInCount;
+            s.pagedOut = pagedOutCount;
+        });
+        s.lineCount = lineCount;
+        return s;
+    }
     int getCurrentLine() const { return currentInstructionIndex; }
-    int getLineCount() const { return instructions.size(); }
+    // Creation to finish, in scheduler-clock ms; -1 while still live.
+    long long getTurnaroundMs() const {
+        long long finished = finishedClock;
+        return finished > 0 ? finished - createdClock : -1;
+    }
+    // Total time spent in the ready queue before being dispatched.
+    long long getWaitingMs() const { return waitedMs; }
+    int getLineCount() const { return lineCount; }
+    size_t programSize() const { return program ? program->size() : 0; }
 
     
-    void executeNextInstruction(int coreId) {
+    // Runs one instruction and reports whether the process has to give up the core.
+    Suspend executeNextInstruction(int coreId) {
         extern std::atomic<bool> cpuRunning;
 
         if (!cpuRunning) {
-            state = ProcessState::FINISHED;
-            logs.push_back(getCurrentTimestamp() + " Execution stopped due to scheduler stop.");
-            return;
+            moveTo(ProcessState::FINISHED);
+            logs.append(getCurrentTimestamp() + " Execution stopped due to scheduler stop.");
+            return Suspend::FINISHED;
         }
 
-        if (currentInstructionIndex >= instructions.size()) {
-            state = ProcessState::FINISHED;
-            return;
+        if (currentInstructionIndex >= static_cast<int>(programSize())) {
+            moveTo(ProcessState::FINISHED);
+            return Suspend::FINISHED;
         }
 
-        Instruction& instr = instructions[currentInstructionIndex];
+        const Instruction& instr = (*program)[currentInstructionIndex];
 
         std::string logEntry = getCurrentTimestamp() +
             " Core [" + std::to_string(coreId) + "] \"" + instr.parameters + "\" from " + name;
-        logs.push_back(logEntry);
+        logs.append(std::move(logEntry));
 
         if (instr.type == Instruction::Type::WRITE || instr.type == Instruction::Type::DECLARE) {
             allocateMemory(1);
         }
 
-        instr.execute(this);
-        currentInstructionIndex++;
+        uint64_t startNs = perfStats.enabled() ? PerfStats::nowNs() : 0;
+        bool faulted = instr.execute(this);
+        if (startNs) perfStats.record(static_cast<int>(instr.type), PerfStats::nowNs() - startNs);
 
-        if (currentInstructionIndex >= instructions.size())
-            state = ProcessState::FINISHED;
-    }
+        seq.writeBegin();
+        currentInstructionIndex++;
+        if (table) table->setLine(slot, currentInstructionIndex);
+        if (currentInstructionIndex >= static_cast<int>(programSize()) && state != ProcessState::WAITING)
+            moveTo(ProcessState::FINISHED);
+        seq.writeEnd();
 
-    void run(int coreId = 0, int delayMs = 10) {
-        state = ProcessState::RUNNING;
-        while (currentInstructionIndex < instructions.size() && cpuRunning) {
-            executeNextInstruction(coreId);
-            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
-        }
-        if (!cpuRunning) {
-            logs.push_back(getCurrentTimestamp() + " Execution halted due to scheduler stop.");
-        }
-        state = ProcessState::FINISHED;
+        if (state == ProcessState::FINISHED) return Suspend::FINISHED;
+        if (state == ProcessState::WAITING) return Suspend::SLEEP;
+        if (faulted) return Suspend::PAGE_FAULT;
+        return Suspend::NONE;
     }
 };
+
+// Every creation site builds its process here: the Process and its shared_ptr control
+// block in one allocation.
+template <typename... Args>
+std::shared_ptr<Process> makeProcess(Args&&... args) {
+    return std::make_shared<Process>(std::forward<Args>(args)...);
+}
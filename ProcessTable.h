@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// The fields monitoring scans read for every process (state, current line, line
+// count, memory used, core), kept as structure-of-arrays columns indexed by registry
+// slot. Each Process writes its own entries as it changes, so screen -ls and
+// report-util stream through dense columns instead of visiting every Process object.
+// Chunks are allocated on first use and never move, like the registry's segments.
+// Columns are relaxed atomics: a scan may mix an entry's old and new values, but
+// never tears one (Process::snapshot() stays the consistent per-process view).
+class ProcessTable {
+public:
+    static constexpr int CHUNK_BITS = 12;
+    static constexpr size_t CHUNK = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << 14;
+
+private:
+    // States are stored as ProcessState + 1, eight to a word, so an unused slot (0)
+    // matches no state and a whole word is tested at once (see countInState).
+    struct Chunk {
+        std::atomic<uint64_t> states[CHUNK / 8] = {};
+        std::atomic<int32_t> line[CHUNK] = {};
+        std::atomic<int32_t> lineCount[CHUNK] = {};
+        std::atomic<int32_t> memoryUsed[CHUNK] = {};
+        std::atomic<int32_t> core[CHUNK] = {};
+    };
+
+    std::atomic<Chunk*> chunks[MAX_CHUNKS] = {};
+    std::atomic<size_t> used{0};   // slots ever attached; scans stop here
+
+    Chunk& chunkOf(size_t slot) const { return *chunks[slot >> CHUNK_BITS].load(std::memory_order_acquire); }
+    static size_t offsetOf(size_t slot) { return slot & (CHUNK - 1); }
+
+    static constexpr uint64_t ONES = 0x0101010101010101ULL;
+    static constexpr uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+
+    // One bit per byte of `word` equal to `value`, counted 8 lanes at a time.
+    static int matchingBytes(uint64_t word, uint8_t value) {
+        uint64_t x = word ^ (ONES * value);
+        uint64_t zeroHigh = ~(((x & LOW7) + LOW7) | x | LOW7);
+        return static_cast<int>(((zeroHigh >> 7) * ONES) >> 56);   // byte-sum; no popcnt needed
+    }
+
+public:
+    ProcessTable() = default;
+    ProcessTable(const ProcessTable&) = delete;
+    ProcessTable& operator=(const ProcessTable&) = delete;
+    ~ProcessTable() {
+        for (auto& c : chunks) delete c.load();
+    }
+
+    // Registry appends are serialized, so only one thread ever adds a chunk.
+    void attach(size_t slot, int state, int line, int lineCount, int memoryUsed, int core) {
+        size_t index = slot >> CHUNK_BITS;
+        if (index >= MAX_CHUNKS) throw std::runtime_error("Process table is full.");
+        if (!chunks[index].load(std::memory_order_relaxed))
+            chunks[index].store(new Chunk(), std::memory_order_release);
+
+        Chunk& c = chunkOf(slot);
+        size_t i = offsetOf(slot);
+        c.line[i].store(line, std::memory_order_relaxed);
+        c.lineCount[i].store(lineCount, std::memory_order_relaxed);
+        c.memoryUsed[i].store(memoryUsed, std::memory_order_relaxed);
+        c.core[i].store(core, std::memory_order_relaxed);
+        setState(slot, state);
+        if (slot >= used.load(std::memory_order_relaxed)) used.store(slot + 1, std::memory_order_release);
+    }
+
+    // Neighbouring slots share a word, so the byte is replaced with a CAS.
+    void setState(size_t slot, int state) {
+        std::atomic<uint64_t>& word = chunkOf(slot).states[offsetOf(slot) / 8];
+        int shift = static_cast<int>(offsetOf(slot) % 8) * 8;
+        uint64_t mask = uint64_t(0xFF) << shift;
+        uint64_t bits = static_cast<uint64_t>(state + 1) << shift;
+        uint64_t old = word.load(std::memory_order_relaxed);
+        while (!word.compare_exchange_weak(old, (old & ~mask) | bits, std::memory_order_relaxed)) {}
+    }
+    void setLine(size_t slot, int line) { chunkOf(slot).line[offsetOf(slot)].store(line, std::memory_order_relaxed); }
+    void setMemoryUsed(size_t slot, int kb) { chunkOf(slot).memoryUsed[offsetOf(slot)].store(kb, std::memory_order_relaxed); }
+    void setCore(size_t slot, int core) { chunkOf(slot).core[offsetOf(slot)].store(core, std::memory_order_relaxed); }
+
+    size_t size() const { return used.load(std::memory_order_acquire); }
+
+    int state(size_t slot) const {
+        uint64_t word = chunkOf(slot).states[offsetOf(slot) / 8].load(std::memory_order_relaxed);
+        return static_cast<int>((word >> (offsetOf(slot) % 8 * 8)) & 0xFF) - 1;
+    }
+    int line(size_t slot) const { return chunkOf(slot).line[offsetOf(slot)].load(std::memory_order_relaxed); }
+    int lineCount(size_t slot) const { return chunkOf(slot).lineCount[offsetOf(slot)].load(std::memory_order_relaxed); }
+    int memoryUsed(size_t slot) const { return chunkOf(slot).memoryUsed[offsetOf(slot)].load(std::memory_order_relaxed); }
+    int core(size_t slot) const { return chunkOf(slot).core[offsetOf(slot)].load(std::memory_order_relaxed); }
+
+    // Whole-table scans: one 64-bit load covers eight processes' states.
+    size_t countInState(int state) const {
+        size_t n = size(), total = 0;
+        uint8_t value = static_cast<uint8_t>(state + 1);
+        for (size_t base = 0; base < n; base += CHUNK) {
+            const Chunk& c = chunkOf(base);
+            size_t words = (std::min(CHUNK, n - base) + 7) / 8;
+            for (size_t w = 0; w < words; ++w)
+                total += matchingBytes(c.states[w].load(std::memory_order_relaxed), value);
+        }
+        return total;
+    }
+
+    long sumMemoryUsed() const {
+        size_t n = size();
+        long total = 0;
+        for (size_t base = 0; base < n; base += CHUNK) {
+            const Chunk& c = chunkOf(base);
+            size_t len = std::min(CHUNK, n - base);
+            for (size_t i = 0; i < len; ++i) total += c.memoryUsed[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Slots in `state`, in registry order.
+    std::vector<size_t> slotsInState(int state) const {
+        std::vector<size_t> out;
+        size_t n = size();
+        uint8_t value = static_cast<uint8_t>(state + 1);
+        for (size_t base = 0; base < n; base += CHUNK) {
+            const Chunk& c = chunkOf(base);
+            size_t words = (std::min(CHUNK, n - base) + 7) / 8;
+            for (size_t w = 0; w < words; ++w) {
+                uint64_t word = c.states[w].load(std::memory_order_relaxed);
+                if (!matchingBytes(word, value)) continue;
+                for (int b = 0; b < 8; ++b) {
+                    if (((word >> (b * 8)) & 0xFF) == value) out.push_back(base + w * 8 + b);
+                }
+            }
+        }
+        return out;
+    }
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <cctype>
+#include "Process.h"
+#include "MemoryManager.h"
+extern MemoryManager memmgr;
+
+// Compacts finished processes off the hot path: logs go to a per-process file under
+// archiveDir, instructions and symbol table are freed, and the process's pages are
+// released. The Process object itself stays in the registry (with its name, archive
+// path and table row), so a finished process still costs a few hundred bytes and that
+// cost grows with the number of processes ever run. With archiving off only the pages
+// are released and the logs stay in memory.
+class Reaper {
+private:
+    std::deque<Process*> pending;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread worker;
+    bool running = false;
+    std::atomic<long> reaped{0};
+
+public:
+    std::string archiveDir = "csopesy-archive";
+    bool archiving = true;   // set before the first retire()
+
+    ~Reaper() { stop(); }
+
+    // The caller must be done touching `proc`; it is archived asynchronously.
+    void retire(Process* proc) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) {
+            running = true;
+            worker = std::thread([this]() { run(); });
+        }
+        pending.push_back(proc);
+        cv.notify_one();
+    }
+
+    // Archives whatever is still queued, then stops the worker.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            running = false;
+        }
+        cv.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+    long reapedCount() const { return reaped.load(); }
+
+private:
+    std::string archivePathFor(const Process* proc) const {
+        std::string file = proc->getProcessName();
+        for (char& c : file)
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') c = '_';
+        return archiveDir + "/" + file + "-" + std::to_string(proc->getPid()) + ".log";
+    }
+
+    void run() {
+        if (archiving) {
+            std::error_code ec;
+            std::filesystem::create_directories(archiveDir, ec);
+        }
+
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this]() { return !pending.empty() || !running; });
+            if (pending.empty() && !running) break;
+
+            std::deque<Process*> batch;
+            batch.swap(pending);
+            lock.unlock();
+
+            for (Process* proc : batch) {
+                if (proc->isArchived()) continue;
+                if (!archiving) {
+                    memmgr.releaseProcess(proc->getProcessName());
+                    continue;
+                }
+                if (proc->archive(archivePathFor(proc))) {
+                    memmgr.releaseProcess(proc->getProcessName());
+                    reaped++;
+                }
+            }
+
+            lock.lock();
+        }
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+// xoshiro256** (Blackman & Vigna). Small, fast and with no shared state, so each
+// thread that draws random numbers owns its own generator; the process generator's
+// stream is seeded from the `seed` config key, making workloads reproducible.
+class Rng {
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    explicit Rng(uint64_t seedValue = 1) { seed(seedValue); }
+
+    // The state is expanded from the seed with splitmix64, so nearby seeds give unrelated streams.
+    void seed(uint64_t seedValue) {
+        uint64_t z = seedValue;
+        for (uint64_t& word : s) {
+            z += 0x9e3779b97f4a7c15ULL;
+            uint64_t x = z;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            word = x ^ (x >> 31);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [lo, hi]. Lemire's multiply-shift with rejection, so there is no modulo bias.
+    int uniform(int lo, int hi) {
+        if (hi <= lo) return lo;
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+        uint64_t x = next() >> 32;
+        uint64_t m = x * range;
+        if ((m & 0xffffffffULL) < range) {
+            uint64_t threshold = (0x100000000ULL - range) % range;
+            while ((m & 0xffffffffULL) < threshold) {
+                x = next() >> 32;
+                m = x * range;
+            }
+        }
+        return static_cast<int>(lo + static_cast<int64_t>(m >> 32));
+    }
+
+    uint64_t state(int i) const { return s[i]; }
+    void setState(int i, uint64_t v) { s[i] = v; }
+};
@@ -8,11 +8,20 @@
 #include <iostream>
 #include <iomanip>
 #include <condition_variable>
+#include <deque>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
 #include "Process.h"
 #include "Instruction.h"
 #include "process_list.h"
 #include "globals.h"
 #include "MemoryManager.h"
+#include "TimerWheel.h"
+#include "Affinity.h"
+#include "Reaper.h"
+#include "Tracer.h"
+#include "Rng.h"
 extern MemoryManager memmgr;
 
 
@@ -22,10 +31,15 @@ public:
     int numCPUs = 1;
     std::string schedulerType = "FCFS";
     int quantumCycles = 5;
-    int batchProcessFreq = 1000;  // milliseconds
+    double batchProcessFreq = 1000;  // milliseconds; fractional means several per ms
     int minInstructions = 3;
     int maxInstructions = 10;
+    int minMemPerProc = 64;       // generated processes get a power of two in this range
+    int maxMemPerProc = 64;
     int delaysPerExec = 0;        // milliseconds
+    int pageFaultTicks = 0;       // disk latency of a page fault; 0 = serviced inline
+    bool pinCores = false;        // bind each core thread to one host CPU
+    long stopAtTick = 0;          // virtual time only: halt the simulation at this tick (0 = never)
 
     //std::atomic<bool> generatorRunning { false };
     //std::atomic<bool> cpuRunning { false };
@@ -33,84 +47,168 @@ public:
     ProcessList allProcesses;
 
 private:
+    friend struct SchedulerProbe;   // microbench.cpp and selftest.cpp drive the scheduler directly
+
     //std::atomic<bool> cpuRunning { false };
     //std::atomic<bool> generatorRunning { false };
     std::vector<std::thread> cpuCores;
     std::thread generatorThread;
+    std::thread timerThread;
     std::mutex mtx;
+    std::mutex timerMtx;
+    std::deque<Process*> readyQueue;
+    std::atomic<size_t> readyLength{0};   // readyQueue.size(), readable without mtx
+    std::deque<Process*> admissionQueue;  // created but waiting for memory, FIFO
+    std::atomic<size_t> admissionLength{0};
+    std::atomic<long> throttledWakes{0};  // generator wakes skipped under backpressure
+    TimerWheel sleepers;
+    // Real time only: the wheel tick that wall-clock timerEpoch corresponds to. Set by
+    // runTimer under timerMtx; wallTimer is false in virtual time and while stopped.
+    bool wallTimer = false;
+    uint64_t timerBaseTick = 0;
+    std::chrono::steady_clock::time_point timerEpoch;
+    std::vector<HostCpu> coreAffinity;
+    std::vector<std::atomic<Process*>> onCore;   // what each core is running, for monitoring
+    Reaper reaper;
     std::condition_variable cv;
-    int processCounter = 1;
+    std::condition_variable readyCv;
+    std::condition_variable timerCv;
+    std::mutex templateMtx;
+    struct ProgramTemplate {
+        std::shared_ptr<const std::vector<Instruction>> program;
+        int totalLines = 0;
+    };
+    std::unordered_map<int, ProgramTemplate> programTemplates;
+    Rng rng;                             // drawn only by whichever thread is generating
+    std::atomic<bool> pausing{false};    // cores park between instructions (see pause)
+    bool pausedGenerator = false;
 
 public:
     Scheduler() {}
     ~Scheduler() { stop(); }
 
-    void schedulerStart() {
-    if (!cpuRunning) {
-        cpuRunning = true;
+    void schedulerStart() { start(true, true); }
 
-        // Start CPU threads
-        for (int i = 0; i < numCPUs; ++i) {
-            cpuCores.emplace_back([this, i]() {
-                while (cpuRunning) {
-                    Process* proc = nullptr;
-
-                    if (schedulerType == "RR" || schedulerType == "rr")
-                        proc = getNextProcessRR();
-                    else
-                        proc = getNextProcessFCFS();
-
-                    if (proc) {
-                        proc->setCurrentCore(i);
-                        while (proc->getState() == ProcessState::RUNNING && cpuRunning) {
-                            proc->executeNextInstruction(i);
-                            activeTicks++;
-                            if (delaysPerExec > 0)
-                                std::this_thread::sleep_for(std::chrono::milliseconds(delaysPerExec));
-                        }
+    // Same seed and config, same sequence of generated processes.
+    void setSeed(uint64_t seed) { rng.seed(seed); }
 
-                        if (proc->getState() != ProcessState::FINISHED && cpuRunning) {
-                            std::lock_guard<std::mutex> lock(mtx);
-                            proc->setState(ProcessState::READY);
-                        }
-                    } else {
-                        idleTicks++;
-                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                    }
-                }
-            });
+    // The generator's stream position travels with a checkpoint.
+    void saveGeneratorState(CheckpointWriter& w) const {
+        for (int i = 0; i < 4; ++i) w.u64(rng.state(i));
+    }
+    // Split in two so a restore can parse the whole image before changing anything.
+    static Rng readGeneratorState(CheckpointReader& r) {
+        Rng g;
+        for (int i = 0; i < 4; ++i) g.setState(i, r.u64());
+        return g;
+    }
+    void setGeneratorState(const Rng& g) { rng = g; }
+
+    // Parks the generator, cores and timer between instructions so the whole emulator
+    // can be serialized. Processes that were on a core go back to the ready queue and
+    // queued retirements are archived. Returns false if the scheduler was not running.
+    bool pause() {
+        if (!cpuRunning) return false;
+        pausedGenerator = generatorRunning;
+        schedulerStop();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            pausing = true;
+        }
+        readyCv.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(timerMtx);
+            timerCv.notify_all();
         }
+        for (auto& t : cpuCores) {
+            if (t.joinable()) t.join();
+        }
+        cpuCores.clear();
+        if (timerThread.joinable()) timerThread.join();
+        reaper.stop();
 
-        std::cout << "CPU threads started.\n";
+        cpuRunning = false;
+        pausing = false;
+        return true;
     }
 
-    if (!generatorRunning) {
-        generatorRunning = true;
+    // Picks up after pause() without generating another initial batch.
+    void resume() { start(pausedGenerator, false); }
 
-        
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            int initialProcs = std::max(4, numCPUs);
-            for (int i = 0; i < initialProcs; ++i)
-                generateRandomProcess();
+    // Sleeping processes with the ticks they still have to wait.
+    std::vector<std::pair<Process*, uint64_t>> sleepingProcesses() {
+        std::lock_guard<std::mutex> lock(timerMtx);
+        std::vector<std::pair<Process*, uint64_t>> out;
+        sleepers.forEach([&out](Process* p, uint64_t left) { out.emplace_back(p, left); });
+        return out;
+    }
+
+    // Re-arms the timer of a WAITING process loaded from a checkpoint.
+    void restoreSleeper(Process* proc) {
+        memmgr.reserve(proc->getMemorySize(), true);
+        proc->setAdmitted(true);
+        scheduleSleeper(proc, proc->takeSleepTicks());
+    }
+
+private:
+    void start(bool withGenerator, bool initialBatch) {
+    bool startVirtual = false;
+    if (!cpuRunning) {
+        cpuRunning = true;
+        rebuildReadyQueue();
+        coreAffinity = pinCores ? planCoreAffinity(numCPUs) : std::vector<HostCpu>{};
+        onCore = std::vector<std::atomic<Process*>>(numCPUs);
+
+        if (virtualTime) {
+            // One thread steps every simulated core per tick, so a run is reproducible.
+            // It is launched below, once the initial processes are queued.
+            startVirtual = true;
+        } else {
+            // Start CPU threads
+            for (int i = 0; i < numCPUs; ++i) {
+                cpuCores.emplace_back([this, i]() { runCore(i); });
+            }
+            timerThread = std::thread([this]() { runTimer(); });
+
+            std::cout << "CPU threads started.\n";
         }
+    }
 
-        
+    if (withGenerator && !generatorRunning) {
+        generatorRunning = true;
+
+        if (initialBatch)
+            generateProcesses(std::max(4, numCPUs));
+
+        // In virtual time the simulation loop admits processes itself.
+        if (!virtualTime)
         generatorThread = std::thread([this]() {
+            auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(generatorPeriodMs()));
+            auto next = std::chrono::steady_clock::now();
             std::unique_lock<std::mutex> lock(mtx);
             while (generatorRunning) {
-                cv.wait_for(lock, std::chrono::milliseconds(batchProcessFreq), [this]() {
-                    return !generatorRunning.load();
-                });
+                // Deadlines, not sleeps, so time spent building does not lower the rate.
+                next += period;
+                cv.wait_until(lock, next, [this]() { return !generatorRunning.load(); });
                 if (!generatorRunning) break;
-                generateRandomProcess();
+                lock.unlock();
+                generatorWake();
+                lock.lock();
             }
         });
 
         std::cout << "Process generator started.\n";
     }
+
+    if (startVirtual) {
+        cpuCores.emplace_back([this]() { runVirtual(); });
+        std::cout << "Virtual-time simulation started.\n";
+    }
 }
 
+public:
+
 
     void schedulerTest(int fastFreqMs = 100) {
         batchProcessFreq = fastFreqMs;
@@ -129,6 +227,15 @@ void schedulerStop() {
     if (generatorThread.joinable()) generatorThread.join();
 }
 
+    // Virtual time with stopAtTick set: blocks until the simulation loop has finished
+    // tick stopAtTick and exited, so counters read afterwards are final. Call stop() after.
+    void waitUntilStopped() {
+        for (auto& t : cpuCores) {
+            if (t.joinable()) t.join();
+        }
+        cpuCores.clear();
+    }
+
 void stop() {
     {
         std::lock_guard<std::mutex> lock(mtx);
@@ -137,6 +244,11 @@ void stop() {
     }
 
     cv.notify_all();
+    readyCv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(timerMtx);
+        timerCv.notify_all();
+    }
 
     if (generatorThread.joinable()) generatorThread.join();
 
@@ -145,90 +257,499 @@ void stop() {
         if (t.joinable()) t.join();
     }
     cpuCores.clear();
+    if (timerThread.joinable()) timerThread.join();
+    reaper.stop();
 
     std::cout << "Scheduler fully stopped.\n";
 }
 
+    // Hands a process created outside the generator (e.g. screen -s) to the cores,
+    // subject to admission control (see admitLocked).
+    void admit(Process* proc) {
+        std::lock_guard<std::mutex> lock(mtx);
+        admitLocked(proc);
+    }
+
+    // Same as admit for many processes: one lock round-trip, every idle core woken.
+    void admitBatch(const std::vector<std::shared_ptr<Process>>& batch) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& p : batch) {
+            if (p) admitLocked(p.get());
+        }
+        readyCv.notify_all();
+    }
+
+    // Processes currently on a core: O(num-cpu), no locks, independent of history size.
+    std::vector<Process*> runningProcesses() const {
+        std::vector<Process*> running;
+        for (auto& slot : onCore) {
+            if (Process* p = slot.load(std::memory_order_acquire))
+                running.push_back(p);
+        }
+        return running;
+    }
+
+    // Finished processes are compacted in the background; see Reaper.
+    void retire(Process* proc) { reaper.retire(proc); }
+    void setArchiving(bool on) { reaper.archiving = on; }
+    long reapedCount() const { return reaper.reapedCount(); }
+
+    bool isVirtual() const { return virtualTime; }
+    const std::vector<HostCpu>& getCoreAffinity() const { return coreAffinity; }
+
+    // Host CPU each core thread is actually bound to (-1 = floating), read back from the OS.
+    std::vector<int> pinnedHostCpus() {
+        std::vector<int> cpus;
+        for (auto& t : cpuCores) cpus.push_back(pinnedCpuOf(t));
+        return cpus;
+    }
+
+    // Ready-queue length for samplers; never takes the scheduler lock.
+    size_t runQueueLength() const { return readyLength.load(std::memory_order_relaxed); }
+    size_t admissionQueueLength() const { return admissionLength.load(std::memory_order_relaxed); }
+    long throttledGeneratorWakes() const { return throttledWakes.load(std::memory_order_relaxed); }
+
+    size_t sleepingCount() {
+        std::lock_guard<std::mutex> lock(timerMtx);
+        return sleepers.size();
+    }
+
 
 private:
-    Process* getNextProcessRR() {
+    bool isRoundRobin() const {
+        return schedulerType == "RR" || schedulerType == "rr";
+    }
+
+    // One idle tick is one instruction slot: delay-per-exec, or 1 ms when there is no delay.
+    long tickMicros() const {
+        return std::max(1, delaysPerExec) * 1000L;
+    }
+
+    // Pinning happens first thing on the core thread, so everything it touches afterwards
+    // (its stack and per-core state) is first-touch allocated on the local NUMA node.
+    void pinCore(int coreId) {
+        if (coreId < static_cast<int>(coreAffinity.size()))
+            pinCurrentThread(coreAffinity[coreId].cpu);
+    }
+
+    void runCore(int coreId) {
+        pinCore(coreId);
+        CoreCounters::bindThreadToCore(coreId);
+        coreCounters.claimLocal();
+        long idleMicros = 0;
+        while (cpuRunning && !pausing) {
+            auto idleStart = std::chrono::steady_clock::now();
+            Process* proc = waitForProcess();
+            idleMicros += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - idleStart).count();
+            coreCounters.add(&CounterShard::idleTicks, idleMicros / tickMicros());
+            idleMicros %= tickMicros();
+
+            if (!proc) continue;
+
+            proc->setCurrentCore(coreId);
+            onCore[coreId].store(proc, std::memory_order_release);
+            coreCounters.add(&CounterShard::contextSwitches, 1);
+            int executed = 0;
+            Suspend why = Suspend::NONE;
+            while (why == Suspend::NONE && cpuRunning && !pausing) {
+                why = step(proc, coreId, executed);
+                coreCounters.add(&CounterShard::activeTicks, 1);
+                if (delaysPerExec > 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delaysPerExec));
+            }
+
+            onCore[coreId].store(nullptr, std::memory_order_release);
+            if (cpuRunning)
+                releaseProcess(proc, why);
+        }
+    }
+
+    // Resumes `proc` for one instruction and turns the outcome into a reason to leave the
+    // core. A fault blocks the process, not the core, when page-fault-ticks is set.
+    Suspend step(Process* proc, int coreId, int& executed) {
+        Suspend why = proc->executeNextInstruction(coreId);
+        if (why == Suspend::PAGE_FAULT) {
+            if (pageFaultTicks > 0) return proc->block(why, pageFaultTicks);
+            why = Suspend::NONE;
+        }
+        if (why == Suspend::NONE && isRoundRobin() && ++executed >= quantumCycles)
+            why = Suspend::QUANTUM;
+        return why;
+    }
+
+    // Decides where a process goes once it leaves the core; the state says where,
+    // `why` only labels the trace.
+    void releaseProcess(Process* proc, Suspend why = Suspend::NONE) {
+        if (tracer.active()) tracer.recordRelease(proc, why);
+        switch (proc->getState()) {
+            case ProcessState::WAITING:
+                scheduleSleeper(proc, proc->takeSleepTicks());
+                break;
+            case ProcessState::RUNNING: {
+                std::lock_guard<std::mutex> lock(mtx);
+                enqueueReadyLocked(proc);
+                break;
+            }
+            case ProcessState::FINISHED:
+                proc->releaseVariables();
+                releaseAdmission(proc);
+                reaper.retire(proc);
+                break;
+            default:
+                break;
+        }
+    }
+
+    uint64_t wallTickLocked() const {
+        return timerBaseTick + std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - timerEpoch).count();
+    }
+
+    // The wheel only moves while it has timers, so after an idle stretch its tick is
+    // behind the wall clock. In real time, bring it up to date first so `ticks` counts
+    // from now; with the wheel empty that is a jump, not a walk over the gap.
+    void scheduleSleeper(Process* proc, uint64_t ticks) {
+        std::vector<Process*> woken;
+        {
+            std::lock_guard<std::mutex> lock(timerMtx);
+            if (wallTimer) sleepers.advance(wallTickLocked(), [&woken](Process* p) { woken.push_back(p); });
+            sleepers.schedule(proc, ticks);
+            timerCv.notify_one();
+        }
+        if (woken.empty()) return;
         std::lock_guard<std::mutex> lock(mtx);
-        static size_t rr_index = 0;
-        auto& procs = allProcesses.getAllProcesses();
-        if (procs.empty()) return nullptr;
+        for (Process* p : woken) enqueueReadyLocked(p);
+    }
+
+    // Wheel ticks are milliseconds; expired sleepers go back to the ready queue.
+    void runTimer() {
+        {
+            std::lock_guard<std::mutex> lock(timerMtx);
+            timerBaseTick = sleepers.currentTick();
+            timerEpoch = std::chrono::steady_clock::now();
+            wallTimer = true;
+        }
 
-        for (size_t i = 0; i < procs.size(); ++i) {
-            size_t idx = (rr_index + i) % procs.size();
-            if (procs[idx]->getState() == ProcessState::READY) {
-                procs[idx]->setState(ProcessState::RUNNING);
-                rr_index = (idx + 1) % procs.size();
-                return procs[idx].get();
+        std::vector<Process*> woken;
+        while (cpuRunning && !pausing) {
+            {
+                // Nothing to expire: park until a process goes to sleep.
+                std::unique_lock<std::mutex> lock(timerMtx);
+                timerCv.wait(lock, [this]() { return !cpuRunning || pausing || sleepers.size() > 0; });
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            {
+                std::lock_guard<std::mutex> lock(timerMtx);
+                sleepers.advance(wallTickLocked(), [&woken](Process* p) { woken.push_back(p); });
+            }
+            if (woken.empty()) continue;
+
+            std::lock_guard<std::mutex> lock(mtx);
+            for (Process* p : woken) enqueueReadyLocked(p);
+            woken.clear();
         }
-        return nullptr;
+        std::lock_guard<std::mutex> lock(timerMtx);
+        wallTimer = false;
     }
 
-    Process* getNextProcessFCFS() {
+    struct VirtualCore {
+        Process* proc = nullptr;
+        int executed = 0;
+        long busyUntil = 0;
+        long idleSlots = 0;
+    };
+
+    // Virtual-time engine. A tick stands for 1 ms of simulated time: every instruction
+    // holds its core for max(1, delay-per-exec) ticks, SLEEP and batch-process-freq
+    // are counted in ticks, and nothing ever waits on the wall clock.
+    void runVirtual() {
+        pinCore(0);
+        std::vector<VirtualCore> cores(numCPUs);
+        const long slot = std::max(1, delaysPerExec);
+        const long genEvery = std::lround(generatorPeriodMs());
+        long nextGen = simTick + genEvery;
+        std::vector<Process*> woken;
+
+        while (cpuRunning && !pausing) {
+            if (stopAtTick > 0 && simTick >= stopAtTick) break;
+            long tick = ++simTick;
+
+            {
+                std::lock_guard<std::mutex> lock(timerMtx);
+                sleepers.advance(tick, [&woken](Process* p) { woken.push_back(p); });
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (Process* p : woken) enqueueReadyLocked(p);
+                woken.clear();
+            }
+            if (generatorRunning && tick >= nextGen) {
+                generatorWake();
+                nextGen = tick + genEvery;
+            }
+
+            bool anyBusy = false;
+            for (int i = 0; i < numCPUs; ++i) {
+                VirtualCore& core = cores[i];
+                CoreCounters::bindThreadToCore(i);
+                if (core.busyUntil > tick) { anyBusy = true; continue; }
+
+                if (!core.proc) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    core.proc = popReadyLocked();
+                    if (!core.proc) {
+                        if (++core.idleSlots >= slot) {
+                            coreCounters.add(&CounterShard::idleTicks, 1);
+                            core.idleSlots = 0;
+                        }
+                        continue;
+                    }
+                    core.proc->setCurrentCore(i);
+                    core.executed = 0;
+                    onCore[i].store(core.proc, std::memory_order_release);
+                    coreCounters.add(&CounterShard::contextSwitches, 1);
+                }
+
+                Process* proc = core.proc;
+                Suspend why = step(proc, i, core.executed);
+                coreCounters.add(&CounterShard::activeTicks, 1);
+                core.busyUntil = tick + slot;
+                anyBusy = true;
+
+                if (why != Suspend::NONE) {
+                    onCore[i].store(nullptr, std::memory_order_release);
+                    releaseProcess(proc, why);
+                    core.proc = nullptr;
+                }
+            }
+
+            if (!anyBusy) fastForwardIdle(cores, slot, nextGen);
+        }
+
+        if (pausing) {
+            for (int i = 0; i < numCPUs; ++i) {
+                if (!cores[i].proc) continue;
+                onCore[i].store(nullptr, std::memory_order_release);
+                releaseProcess(cores[i].proc);
+            }
+        }
+    }
+
+    // Every core is idle: skip straight to the next event instead of spinning through empty ticks.
+    void fastForwardIdle(std::vector<VirtualCore>& cores, long slot, long nextGen) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!readyQueue.empty() || sleepingCount() > 0) return;
+
+        // With a stop tick and no generator, the run would otherwise idle forever.
+        if (generatorRunning || stopAtTick > 0) {
+            long until = generatorRunning ? nextGen - 1 : stopAtTick;
+            if (stopAtTick > 0) until = std::min(until, stopAtTick);
+            long skipped = until - simTick;
+            if (skipped <= 0) return;
+            simTick += skipped;
+            for (size_t i = 0; i < cores.size(); ++i) {
+                cores[i].idleSlots += skipped;
+                coreCounters.addForCore(static_cast<int>(i), &CounterShard::idleTicks, cores[i].idleSlots / slot);
+                cores[i].idleSlots %= slot;
+            }
+            return;
+        }
+
+        // Nothing can happen until new work arrives; simulated time stands still.
+        readyCv.wait(lock, [this]() {
+            return !cpuRunning || pausing || !readyQueue.empty() || generatorRunning;
+        });
+    }
+
+    void enqueueReadyLocked(Process* proc) {
+        proc->setState(ProcessState::READY);
+        readyQueue.push_back(proc);
+        readyLength.store(readyQueue.size(), std::memory_order_relaxed);
+        readyCv.notify_one();
+    }
+
+    void rebuildReadyQueue() {
+        std::lock_guard<std::mutex> lock(mtx);
+        readyQueue.clear();
+        admissionQueue.clear();
+        for (auto& p : allProcesses.getAllProcesses()) {
+            if (p->getState() == ProcessState::READY)
+                admitLocked(p.get());
+        }
+        readyLength.store(readyQueue.size(), std::memory_order_relaxed);
+        admissionLength.store(admissionQueue.size(), std::memory_order_relaxed);
+    }
+
+    // Admission control: a process is queued to run only once its declared memory fits
+    // in physical frames next to every admitted, unfinished process. The rest wait in
+    // FIFO order, so a large process is not overtaken forever by small ones.
+    void admitLocked(Process* proc) {
+        if (!proc->isAdmitted()) {
+            if (!admissionQueue.empty() || !memmgr.reserve(proc->getMemorySize())) {
+                admissionQueue.push_back(proc);
+                admissionLength.store(admissionQueue.size(), std::memory_order_relaxed);
+                return;
+            }
+            proc->setAdmitted(true);
+        }
+        enqueueReadyLocked(proc);
+    }
+
+    // A finished process gives its frames back; waiting processes are admitted from the head.
+    void releaseAdmission(Process* proc) {
+        if (!proc->isAdmitted()) return;
+        proc->setAdmitted(false);
+        memmgr.unreserve(proc->getMemorySize());
+
         std::lock_guard<std::mutex> lock(mtx);
-        auto& procs = allProcesses.getAllProcesses();
-        for (auto& p : procs) {
-            if (p->getState() == ProcessState::READY) {
-                p->setState(ProcessState::RUNNING);
-                return p.get();
+        while (!admissionQueue.empty()) {
+            Process* next = admissionQueue.front();
+            if (!memmgr.reserve(next->getMemorySize())) break;
+            admissionQueue.pop_front();
+            next->setAdmitted(true);
+            enqueueReadyLocked(next);
+        }
+        admissionLength.store(admissionQueue.size(), std::memory_order_relaxed);
+    }
+
+    // FCFS and RR share one FIFO; RR differs only in giving up the core after a quantum.
+    Process* popReadyLocked() {
+        while (!readyQueue.empty()) {
+            Process* proc = readyQueue.front();
+            readyQueue.pop_front();
+            readyLength.store(readyQueue.size(), std::memory_order_relaxed);
+            if (proc->getState() == ProcessState::READY) {
+                proc->setState(ProcessState::RUNNING);
+                if (tracer.active()) tracer.record(Tracer::EventType::DISPATCH, proc);
+                return proc;
             }
         }
         return nullptr;
     }
 
-    void generateRandomProcess() {
-        int numInstr = minInstructions + (std::rand() % (maxInstructions - minInstructions + 1));
-        if (numInstr < 3) numInstr = 3;
+    // Idle cores block here until something is enqueued or the scheduler stops.
+    Process* waitForProcess() {
+        std::unique_lock<std::mutex> lock(mtx);
+        Process* proc = nullptr;
+        readyCv.wait(lock, [this, &proc]() {
+            if (pausing) return true;
+            proc = popReadyLocked();
+            return proc != nullptr || !cpuRunning;
+        });
+        return proc;
+    }
 
+    // The generated program depends only on the instruction count, so each count is
+    // built once and shared by every process that draws it.
+    static std::vector<Instruction> buildProgram(int numInstr) {
         std::vector<Instruction> instrs;
+        instrs.reserve(2 * numInstr);   // upper bound on what the loops below emit
         std::vector<std::string> vars;
 
         for (int i = 0; i < numInstr / 3; ++i) {
             std::string varName = "x" + std::to_string(i);
-            instrs.push_back(Instruction(Instruction::Type::DECLARE, varName + " 0"));
-            vars.push_back(varName);
+            instrs.emplace_back(Instruction::Type::DECLARE, varName + " 0");
+            vars.push_back(std::move(varName));
         }
 
         for (int i = 0; i < numInstr / 3; ++i) {
             if (vars.size() >= 2) {
                 std::string cmd = vars[0] + " " + vars[0] + " " + vars[1];
-                instrs.push_back(Instruction(Instruction::Type::ADD, cmd));
-                instrs.push_back(Instruction(Instruction::Type::SUB, cmd));
+                instrs.emplace_back(Instruction::Type::ADD, cmd);
+                instrs.emplace_back(Instruction::Type::SUB, std::move(cmd));
             } else if (!vars.empty()) {
-                std::string cmd = vars[0] + " " + vars[0] + " 1";
-                instrs.push_back(Instruction(Instruction::Type::ADD, cmd));
+                instrs.emplace_back(Instruction::Type::ADD, vars[0] + " " + vars[0] + " 1");
             }
         }
 
         for (int i = 0; i < numInstr / 6; ++i) {
             if (!vars.empty()) {
-                std::string var = vars[i % vars.size()];
+                const std::string& var = vars[i % vars.size()];
                 std::ostringstream addr;
                 addr << "0x" << std::hex << (0x500 + i * 2);
-                instrs.push_back(Instruction(Instruction::Type::WRITE, addr.str() + " " + var));
+                instrs.emplace_back(Instruction::Type::WRITE, addr.str() + " " + var);
                 std::string readVar = "r" + std::to_string(i);
-                instrs.push_back(Instruction(Instruction::Type::READ, readVar + " " + addr.str()));
-                vars.push_back(readVar);
+                instrs.emplace_back(Instruction::Type::READ, readVar + " " + addr.str());
+                vars.push_back(std::move(readVar));
             }
         }
 
         for (auto& v : vars) {
-            instrs.push_back(Instruction(Instruction::Type::PRINT, v));
+            instrs.emplace_back(Instruction::Type::PRINT, v);
+        }
+        return instrs;
+    }
+
+    // At most TEMPLATE_POOL programs are kept: a wider min-ins..max-ins range is snapped
+    // to that many evenly spaced counts.
+    static constexpr int TEMPLATE_POOL = 256;
+
+    ProgramTemplate programTemplate(int numInstr) {
+        int range = maxInstructions - minInstructions;
+        if (range >= TEMPLATE_POOL) {
+            long step = (static_cast<long>(numInstr - minInstructions) * (TEMPLATE_POOL - 1) + range / 2) / range;
+            numInstr = minInstructions + static_cast<int>(step * range / (TEMPLATE_POOL - 1));
+            if (numInstr < 3) numInstr = 3;
         }
 
-        std::ostringstream oss;
-        oss << "p" << std::setw(2) << std::setfill('0') << processCounter;
-        std::string procName = oss.str();
+        std::lock_guard<std::mutex> lock(templateMtx);
+        auto& slot = programTemplates[numInstr];
+        if (!slot.program) {
+            slot.program = std::make_shared<const std::vector<Instruction>>(buildProgram(numInstr));
+            slot.totalLines = Process::countTotalLines(*slot.program);
+        }
+        return slot;
+    }
+
+    // Runs without the scheduler lock.
+    std::shared_ptr<Process> buildRandomProcess() {
+        int numInstr = rng.uniform(minInstructions, maxInstructions);
+        if (numInstr < 3) numInstr = 3;
+        int memSize = randomMemorySize();
+
+        int pid = processCounter++;
+        std::string procName = (pid < 10 ? "p0" : "p") + std::to_string(pid);
+        ProgramTemplate tmpl = programTemplate(numInstr);
+        return makeProcess(pid, std::move(procName), std::move(tmpl.program), memSize, tmpl.totalLines);
+    }
 
-        Process newProc(processCounter, procName, instrs);
-        newProc.setState(ProcessState::READY);
-        allProcesses.addProcess(newProc);
+    // Process memory must be a power of two, so the exponent is drawn uniformly from
+    // those that fall inside min-mem-per-proc..max-mem-per-proc.
+    int randomMemorySize() {
+        int lo = 6, hi = 16;   // 64..65536 bytes
+        while (lo < hi && (1 << lo) < minMemPerProc) ++lo;
+        while (hi > lo && (1 << hi) > maxMemPerProc) --hi;
+        return 1 << rng.uniform(lo, hi);
+    }
+
+    // Builds `count` processes outside mtx, then registers and queues them as one batch.
+    void generateProcesses(int count) {
+        std::vector<std::shared_ptr<Process>> batch;
+        batch.reserve(count);
+        for (int i = 0; i < count; ++i) batch.push_back(buildRandomProcess());
+        allProcesses.addProcesses(batch);
+        admitBatch(batch);
+    }
+
+    // Backpressure: while this many processes already wait for memory, generator wakes
+    // create nothing, so generation settles to the rate at which processes finish.
+    size_t admissionBacklog() const { return std::max<size_t>(64, 4 * static_cast<size_t>(numCPUs)); }
+
+    void generatorWake() {
+        if (admissionLength.load(std::memory_order_relaxed) >= admissionBacklog()) {
+            throttledWakes.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        generateProcesses(processesPerWake());
+    }
 
-        //std::cout << "Generated process: " << procName << " with " << instrs.size() << " instructions.\n";
-        processCounter++;
+    // batch-process-freq may be fractional. Below 1 ms the generator still wakes once
+    // per ms (once per tick in virtual time) but admits several processes each time.
+    double generatorPeriodMs() const { return std::max(1.0, batchProcessFreq); }
+    int processesPerWake() const {
+        if (batchProcessFreq >= 1.0) return 1;
+        return static_cast<int>(std::lround(1.0 / std::max(batchProcessFreq, 0.001)));
     }
 };
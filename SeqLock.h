@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <thread>
+
+// Field that one thread writes while others read it without locking.
+// Accesses are relaxed atomics, so a reader never sees a torn value; a SeqLock
+// around a group of them gives readers a consistent view of the whole group.
+template <typename T>
+class SeqField {
+private:
+    std::atomic<T> value;
+
+public:
+    SeqField(T v = T()) : value(v) {}
+    SeqField& operator=(T v) { store(v); return *this; }
+
+    T load() const { return value.load(std::memory_order_relaxed); }
+    void store(T v) { value.store(v, std::memory_order_relaxed); }
+    operator T() const { return load(); }
+
+    // Single writer, so read-modify-write does not need to be atomic.
+    SeqField& operator++() { store(load() + 1); return *this; }
+    T operator++(int) { T old = load(); store(old + 1); return old; }
+    SeqField& operator+=(T d) { store(load() + d); return *this; }
+    SeqField& operator-=(T d) { store(load() - d); return *this; }
+};
+
+// Sequence lock: the writer makes the counter odd while it updates, readers retry
+// until they see the same even value before and after. Writers never wait on readers.
+class SeqLock {
+private:
+    std::atomic<unsigned> seq{0};
+
+public:
+    SeqLock() = default;
+    SeqLock(const SeqLock&) {}
+    SeqLock& operator=(const SeqLock&) { return *this; }
+
+    void writeBegin() {
+        seq.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void writeEnd() {
+        seq.fetch_add(1, std::memory_order_release);
+    }
+
+    template <typename F>
+    void read(F&& readFields) const {
+        for (int spins = 0;; ++spins) {
+            unsigned before = seq.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                readFields();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) == before) return;
+            }
+            if (spins > 64) std::this_thread::yield();
+        }
+    }
+};
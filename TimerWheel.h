@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class Process;
+
+// Hierarchical timing wheel: 4 levels of 64 slots, one tick per slot at level 0.
+// Timers further out than 64^4 ticks wait in an overflow list until the top level wraps.
+class TimerWheel {
+public:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+private:
+    struct Timer {
+        uint64_t expiry;
+        Process* proc;
+    };
+
+    std::vector<Timer> wheel[LEVELS][SLOTS];
+    std::vector<Timer> overflow;
+    uint64_t now = 0;
+    size_t pending = 0;
+
+public:
+    uint64_t currentTick() const { return now; }
+    size_t size() const { return pending; }
+
+    void schedule(Process* proc, uint64_t delayTicks) {
+        if (delayTicks == 0) delayTicks = 1;
+        insert({ now + delayTicks, proc });
+        pending++;
+    }
+
+    // Moves the wheel forward to `to`, calling onExpire(Process*) for every timer that fires.
+    template <typename F>
+    void advance(uint64_t to, F&& onExpire) {
+        while (now < to) {
+            if (pending == 0) { now = to; return; }
+            now++;
+
+            // Higher levels are cascaded first so their timers can drop into lower slots.
+            int top = 0;
+            while (top + 1 < LEVELS && (now & ((uint64_t(1) << (SLOT_BITS * (top + 1))) - 1)) == 0)
+                top++;
+            if (top == LEVELS - 1 && (now & ((uint64_t(1) << (SLOT_BITS * LEVELS)) - 1)) == 0)
+                cascadeOverflow();
+            for (int level = top; level >= 1; --level)
+                cascade(level);
+
+            std::vector<Timer> expired;
+            expired.swap(wheel[0][now & SLOT_MASK]);
+            for (auto& t : expired) {
+                pending--;
+                onExpire(t.proc);
+            }
+        }
+    }
+
+    // Calls fn(Process*, ticksLeft) for every pending timer, in no particular order.
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (const auto& level : wheel)
+            for (const auto& slot : level)
+                for (const auto& t : slot) fn(t.proc, t.expiry > now ? t.expiry - now : 0);
+        for (const auto& t : overflow) fn(t.proc, t.expiry > now ? t.expiry - now : 0);
+    }
+
+private:
+    void insert(const Timer& t) {
+        // Pick the lowest level whose higher-order bits already match the current tick,
+        // so the slot index at that level is strictly ahead of the wheel's position.
+        for (int level = 0; level < LEVELS; ++level) {
+            int shift = SLOT_BITS * (level + 1);
+            if ((t.expiry >> shift) == (now >> shift)) {
+                wheel[level][(t.expiry >> (SLOT_BITS * level)) & SLOT_MASK].push_back(t);
+                return;
+            }
+        }
+        overflow.push_back(t);
+    }
+
+    void cascade(int level) {
+        std::vector<Timer> moved;
+        moved.swap(wheel[level][(now >> (SLOT_BITS * level)) & SLOT_MASK]);
+        for (auto& t : moved) insert(t);
+    }
+
+    void cascadeOverflow() {
+        std::vector<Timer> moved;
+        moved.swap(overflow);
+        for (auto& t : moved) insert(t);
+    }
+};
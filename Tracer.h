@@ -0,0 +1,192 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+#include "CoreCounters.h"
+#include "PerfStats.h"
+#include "Process.h"
+
+// Scheduling timeline recorder (trace start / trace stop <file>). Each thread appends
+// to the fixed buffer of its CoreCounters shard: a slot is reserved with one relaxed
+// fetch_add and published through `committed`, so recording never takes a lock.
+// stop() writes Chrome trace-event JSON, viewable in chrome://tracing or Perfetto.
+class Tracer {
+public:
+    enum class EventType : uint8_t { DISPATCH, PREEMPT, FINISH, SLEEP, PAGE_FAULT, IO_WAIT };
+
+    struct Event {
+        uint64_t ns;        // scheduler clock, see PerfStats::dispatchClockNs
+        Process* proc;      // registry entries are never freed, so this stays valid
+        EventType type;
+        uint32_t arg;       // page-fault address
+    };
+
+    static constexpr size_t EVENTS_PER_SHARD = size_t(1) << 18;
+
+private:
+    struct Buffer {
+        std::vector<Event> events = std::vector<Event>(EVENTS_PER_SHARD);
+        std::atomic<size_t> reserved{0};
+        std::atomic<size_t> committed{0};
+        std::atomic<size_t> dropped{0};
+    };
+
+    std::atomic<bool> on{false};
+    std::atomic<Buffer*> buffers[CoreCounters::MAX_SHARDS] = {};
+    uint64_t startNs = 0;
+
+    Buffer* bufferAt(int index) {
+        Buffer* b = buffers[index].load(std::memory_order_acquire);
+        if (b) return b;
+        Buffer* fresh = new Buffer();
+        if (buffers[index].compare_exchange_strong(b, fresh, std::memory_order_acq_rel)) return fresh;
+        delete fresh;
+        return b;
+    }
+
+public:
+    Tracer() = default;
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    ~Tracer() {
+        for (auto& b : buffers) delete b.load();
+    }
+
+    bool active() const { return on.load(std::memory_order_relaxed); }
+
+    void record(EventType type, Process* proc, uint32_t arg = 0) {
+        Buffer* b = bufferAt(CoreCounters::currentShard());
+        size_t slot = b->reserved.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= EVENTS_PER_SHARD) {
+            b->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        b->events[slot] = Event{ PerfStats::dispatchClockNs(), proc, type, arg };
+        b->committed.fetch_add(1, std::memory_order_release);
+    }
+
+    // Called when a core gives a process up; without an explicit reason it follows from the new state.
+    void recordRelease(Process* proc, Suspend why = Suspend::NONE) {
+        if (why == Suspend::PAGE_FAULT) {
+            record(EventType::IO_WAIT, proc);
+            return;
+        }
+        switch (proc->getState()) {
+            case ProcessState::WAITING:  record(EventType::SLEEP, proc); break;
+            case ProcessState::FINISHED: record(EventType::FINISH, proc); break;
+            default:                     record(EventType::PREEMPT, proc); break;
+        }
+    }
+
+    void start() {
+        for (auto& b : buffers) {
+            if (Buffer* buf = b.load(std::memory_order_acquire)) {
+                buf->reserved.store(0, std::memory_order_relaxed);
+                buf->committed.store(0, std::memory_order_relaxed);
+                buf->dropped.store(0, std::memory_order_relaxed);
+            }
+        }
+        startNs = PerfStats::dispatchClockNs();
+        on.store(true, std::memory_order_release);
+    }
+
+    // Stops recording and writes the trace. Returns the number of events written.
+    size_t stop(const std::string& filename) {
+        on.store(false, std::memory_order_release);
+        uint64_t stopNs = PerfStats::dispatchClockNs();
+
+        std::ofstream ofs(filename);
+        if (!ofs.is_open()) throw std::runtime_error("Unable to open file: " + filename);
+
+        size_t written = 0, dropped = 0;
+        bool first = true;
+        auto next = [&ofs, &first]() -> std::ofstream& {
+            ofs << (first ? "\n" : ",\n");
+            first = false;
+            return ofs;
+        };
+
+        ofs << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        next() << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"csopesy\"}}";
+
+        for (int i = 0; i < CoreCounters::MAX_SHARDS; ++i) {
+            Buffer* b = buffers[i].load(std::memory_order_acquire);
+            if (!b) continue;
+
+            // Wait for writers that reserved a slot before recording was switched off.
+            size_t n = std::min(b->reserved.load(std::memory_order_acquire), EVENTS_PER_SHARD);
+            for (int spins = 0; b->committed.load(std::memory_order_acquire) < n && spins < 10000; ++spins)
+                std::this_thread::yield();
+            n = std::min(n, b->committed.load(std::memory_order_acquire));
+            dropped += b->dropped.load(std::memory_order_relaxed);
+            if (n == 0) continue;
+
+            int tid = i;   // tid 0 is every non-core thread, tid k is core k-1
+            next() << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"name\":\"thread_name\",\"args\":{\"name\":\""
+                   << (i == 0 ? std::string("other threads") : "Core " + std::to_string(i - 1)) << "\"}}";
+
+            // Each dispatch opens a slice on this core; the next release closes it.
+            Process* open = nullptr;
+            uint64_t openNs = startNs;
+            for (size_t k = 0; k < n; ++k) {
+                const Event& e = b->events[k];
+                if (e.type == EventType::DISPATCH) {
+                    if (open) writeSlice(next(), tid, open, openNs, e.ns, "unknown");
+                    open = e.proc;
+                    openNs = e.ns;
+                } else if (e.type == EventType::PAGE_FAULT) {
+                    next() << "{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << toUs(e.ns)
+                           << ",\"name\":\"page-fault\",\"args\":{\"process\":\"" << escape(e.proc->getProcessName())
+                           << "\",\"addr\":" << e.arg << "}}";
+                } else {
+                    // A release with no dispatch in the buffer began before trace start.
+                    if (open && open != e.proc) writeSlice(next(), tid, open, openNs, e.ns, "unknown");
+                    writeSlice(next(), tid, e.proc, open == e.proc ? openNs : startNs, e.ns, reasonOf(e.type));
+                    open = nullptr;
+                }
+                ++written;
+            }
+            if (open) writeSlice(next(), tid, open, openNs, stopNs, "running");
+        }
+
+        ofs << "\n],\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+        return written;
+    }
+
+private:
+    static double toUs(uint64_t ns) { return ns / 1000.0; }
+
+    static const char* reasonOf(EventType type) {
+        switch (type) {
+            case EventType::PREEMPT: return "preempt";
+            case EventType::FINISH:  return "finish";
+            case EventType::SLEEP:   return "sleep";
+            case EventType::IO_WAIT: return "io-wait";
+            default:                 return "unknown";
+        }
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) out += c;
+        }
+        return out;
+    }
+
+    static void writeSlice(std::ofstream& ofs, int tid, Process* proc, uint64_t fromNs, uint64_t toNs,
+                           const char* reason) {
+        ofs << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << toUs(fromNs)
+            << ",\"dur\":" << toUs(toNs >= fromNs ? toNs - fromNs : 0)
+            << ",\"name\":\"" << escape(proc->getProcessName()) << "\",\"args\":{\"pid\":" << proc->getPid()
+            << ",\"end\":\"" << reason << "\"}}";
+    }
+};
+
+extern Tracer tracer;
@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <condition_variable>
+#include <filesystem>
+#include "CoreCounters.h"
+#include "MemoryManager.h"
+#include "Scheduler.h"
+#include "globals.h"
+extern MemoryManager memmgr;
+
+// Background sampler behind `vmstat -n <interval_ms>`. Every interval it appends one
+// CSV row built only from relaxed counter loads (CoreCounters, the pager's resident
+// frame count, the scheduler's run-queue length), so core threads are never blocked.
+// Rows go through a large stream buffer and reach the file in big writes.
+class VmStatSampler {
+private:
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool running = false;
+    std::ofstream out;
+    char buffer[1 << 16];
+    long rows = 0;
+
+public:
+    ~VmStatSampler() { stop(); }
+
+    void start(const Scheduler& sched, int intervalMs, const std::string& filename) {
+        stop();
+        std::error_code ec;
+        bool fresh = !std::filesystem::exists(filename, ec) || std::filesystem::file_size(filename, ec) == 0;
+        out.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
+        out.open(filename, std::ios::app);
+        if (!out.is_open()) throw std::runtime_error("Unable to open file: " + filename);
+        if (fresh)
+            out << "time_ms,used_frames,free_frames,paged_in,paged_out,active_ticks,idle_ticks,run_queue\n";
+
+        rows = 0;
+        running = true;
+        worker = std::thread([this, &sched, intervalMs]() { run(sched, intervalMs); });
+    }
+
+    // Returns the number of rows written by the sampler that was running.
+    long stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running) return 0;
+            running = false;
+        }
+        cv.notify_all();
+        if (worker.joinable()) worker.join();
+        out.close();
+        return rows;
+    }
+
+private:
+    void run(const Scheduler& sched, int intervalMs) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (running) {
+            size_t used = memmgr.peekUsedFrames();
+            size_t total = memmgr.getTotalFrames();
+            out << schedulerClockMs() << ','
+                << used << ',' << (total > used ? total - used : 0) << ','
+                << coreCounters.pagedIn() << ',' << coreCounters.pagedOut() << ','
+                << coreCounters.activeTicks() << ',' << coreCounters.idleTicks() << ','
+                << sched.runQueueLength() << '\n';
+            ++rows;
+            cv.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return !running; });
+        }
+    }
+};
@@ -0,0 +1,152 @@
+#include "benchmark.h"
+#include "Scheduler.h"
+#include "process_list.h"
+#include "CoreCounters.h"
+#include "MemoryManager.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+extern int numCPUs;
+extern MemoryManager memmgr;
+extern std::string schedulerType;
+void setConfig(const std::string& path);
+void applyConfig(Scheduler& s);
+
+struct CoreSample {
+    long active;
+    long idle;
+};
+
+static std::vector<CoreSample> sampleCores(int cores) {
+    std::vector<CoreSample> out;
+    for (int i = 0; i < cores; ++i)
+        out.push_back({ coreCounters.ofCore(i, &CounterShard::activeTicks),
+                        coreCounters.ofCore(i, &CounterShard::idleTicks) });
+    return out;
+}
+
+static double percentile(std::vector<long long>& values, double p) {
+    if (values.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return static_cast<double>(values[idx]);
+}
+
+// One run at a given core count. Counters are global, so everything is measured as a delta.
+static std::string runOnce(int cores, double durationSec) {
+    Scheduler bench;
+    applyConfig(bench);
+    bench.numCPUs = cores;
+    bench.setArchiving(false);   // measure scheduling, not one log file per finished process
+
+    memmgr.reset();
+    std::vector<CoreSample> before = sampleCores(cores);
+    long faultsBefore = coreCounters.total(&CounterShard::pageFaults);
+    long startTick = simTick.load();
+    auto start = std::chrono::steady_clock::now();
+    // Duration is simulated time in virtual mode: one tick is one simulated millisecond.
+    long targetTick = startTick + static_cast<long>(durationSec * 1000);
+    if (virtualTime) bench.stopAtTick = targetTick;
+
+    bench.schedulerStart();
+    if (virtualTime)
+        bench.waitUntilStopped();   // the loop halts itself at targetTick
+    else
+        std::this_thread::sleep_for(std::chrono::duration<double>(durationSec));
+    bench.stop();
+
+    double elapsed = virtualTime
+        ? (simTick.load() - startTick) / 1000.0
+        : std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<CoreSample> after = sampleCores(cores);
+    long faults = coreCounters.total(&CounterShard::pageFaults) - faultsBefore;
+
+    long instructions = 0;
+    std::vector<double> util;
+    for (int i = 0; i < cores; ++i) {
+        long active = after[i].active - before[i].active;
+        long idle = after[i].idle - before[i].idle;
+        instructions += active;
+        util.push_back((active + idle) > 0 ? 100.0 * active / (active + idle) : 0.0);
+    }
+
+    std::vector<long long> turnaround, waiting;
+    for (const auto& p : bench.allProcesses.getAllProcesses()) {
+        ProcessSnapshot s = p->snapshot();
+        if (s.state != ProcessState::FINISHED || s.currentLine < s.lineCount) continue;
+        turnaround.push_back(p->getTurnaroundMs());
+        waiting.push_back(p->getWaitingMs());
+    }
+
+    std::ostringstream json;
+    json << "{\"num_cpu\":" << cores
+         << ",\"scheduler\":\"" << schedulerType << "\""
+         << ",\"clock\":\"" << (virtualTime ? "virtual" : "real") << "\""
+         << ",\"duration_s\":" << elapsed
+         << ",\"instructions\":" << instructions
+         << ",\"instructions_per_s\":" << (elapsed > 0 ? instructions / elapsed : 0.0)
+         << ",\"processes_created\":" << bench.allProcesses.size()
+         << ",\"processes_completed\":" << turnaround.size()
+         << ",\"processes_completed_per_s\":" << (elapsed > 0 ? turnaround.size() / elapsed : 0.0)
+         << ",\"turnaround_ms_p50\":" << percentile(turnaround, 0.50)
+         << ",\"turnaround_ms_p99\":" << percentile(turnaround, 0.99)
+         << ",\"waiting_ms_p50\":" << percentile(waiting, 0.50)
+         << ",\"waiting_ms_p99\":" << percentile(waiting, 0.99)
+         << ",\"page_faults\":" << faults
+         << ",\"fault_rate\":" << (instructions > 0 ? static_cast<double>(faults) / instructions : 0.0)
+         << ",\"awaiting_admission\":" << bench.admissionQueueLength()
+         << ",\"generator_throttled\":" << bench.throttledGeneratorWakes()
+         << ",\"core_util\":[";
+    for (size_t i = 0; i < util.size(); ++i)
+        json << (i ? "," : "") << util[i];
+    json << "]}";
+    return json.str();
+}
+
+static void usage() {
+    std::cerr << "Usage: csopesy --bench <config> --duration <seconds> [--sweep 1,2,4,8]\n";
+}
+
+int runBenchmark(int argc, char* argv[]) {
+    if (argc < 3) { usage(); return 2; }
+    std::string configPath = argv[2];
+    double duration = 10.0;
+    std::vector<int> sweep;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--duration" && i + 1 < argc) {
+            duration = std::stod(argv[++i]);
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            std::stringstream ss(argv[++i]);
+            std::string n;
+            while (std::getline(ss, n, ',')) {
+                if (!n.empty()) sweep.push_back(std::stoi(n));
+            }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    // Scheduler and config chatter goes to a muted cout; results go to the real stdout.
+    // cout stays muted so nothing printed at exit lands after the results.
+    std::ostream results(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+
+    setConfig(configPath);
+    if (sweep.empty()) sweep.push_back(numCPUs);
+
+    for (int cores : sweep) {
+        if (cores < 1) continue;
+        results << runOnce(cores, duration) << std::endl;
+    }
+
+    return 0;
+}
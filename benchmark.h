@@ -0,0 +1,5 @@
+#pragma once
+
+// Headless benchmark: csopesy --bench <config> --duration <s> [--sweep 1,2,4,8]
+// Runs the scheduler and generator without the REPL and prints one JSON line per run.
+int runBenchmark(int argc, char* argv[]);
@@ -1,13 +1,16 @@
 #include "console.h"
 #include "MemoryManager.h"
+#include "Scheduler.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <iomanip>
 #include <memory>
 #include <chrono>
 
 extern int numCPUs;
 extern MemoryManager memmgr;
+extern Scheduler sched;
 
 console::console(ProcessList &plist, Process *p)
     : processList(plist), proc(p), totalLines(100) {}
@@ -46,10 +49,11 @@ void console::handleScreen() {
             for (const auto &entry : latestProc->getLogs())
                 std::cout << entry << "\n";
 
-            std::cout << "Current instruction line: " << latestProc->getCurrentLine()
-                      << "\nLines of code: " << latestProc->getLineCount() << "\n";
+            ProcessSnapshot snap = latestProc->snapshot();
+            std::cout << "Current instruction line: " << snap.currentLine
+                      << "\nLines of code: " << snap.lineCount << "\n";
 
-            if (latestProc->getState() == ProcessState::FINISHED)
+            if (snap.state == ProcessState::FINISHED)
                 std::cout << "\nFinished!\n";
         }
         else {
@@ -63,42 +67,36 @@ void console::handleScreenLS() {
 
     const auto& allProcs = processList.getAllProcesses();
 
-    // Calculate CPU utilization
-    int runningProcesses = 0;
-    for (const auto& p : allProcs) {
-        if (p->getState() == ProcessState::RUNNING)
-            runningProcesses++;
-    }
+    // Running set comes straight from the cores; no need to walk the whole history for it.
+    std::vector<Process*> running = sched.runningProcesses();
 
-    double cpuUtil = allProcs.empty() ? 0.0 : (runningProcesses * 100.0) / allProcs.size();
+    // Calculate CPU utilization
+    double cpuUtil = allProcs.empty() ? 0.0 : (running.size() * 100.0) / allProcs.size();
     std::cout << "CPU Utilization: " << std::fixed << std::setprecision(2)
               << cpuUtil << " %\n";
 
     // Running processes
     std::cout << "\nRunning processes:\n";
-    for (const auto &p : allProcs) {
-        if (p->getState() == ProcessState::RUNNING) {
-            // Lock or atomically read the core if needed
-            int core = p->getCurrentCore();
-            std::cout << p->getProcessName()
-                      << " | State: RUNNING"
-                      << " | Core: " << (core == -1 ? "Unassigned" : std::to_string(core))
-                      << " | Line: " << p->getCurrentLine()
-                      << "/" << p->getLineCount()
-                      << "\n";
-        }
+    for (Process* p : running) {
+        ProcessSnapshot s = p->snapshot();
+        if (s.state != ProcessState::RUNNING) continue;
+        std::cout << p->getProcessName()
+                  << " | State: RUNNING"
+                  << " | Core: " << (s.core == -1 ? "Unassigned" : std::to_string(s.core))
+                  << " | Line: " << s.currentLine
+                  << "/" << s.lineCount
+                  << "\n";
     }
 
-    // Finished processes
+    // Finished processes: found from the registry's state column, not by visiting each process.
     std::cout << "\nFinished processes:\n";
-    for (const auto &p : allProcs) {
-        if (p->getState() == ProcessState::FINISHED) {
-            std::cout << p->getProcessName()
-                      << " | State: FINISHED"
-                      << " | Total lines: " << p->getLineCount()
-                      << "/" << p->getLineCount()
-                      << "\n";
-        }
+    const ProcessTable& table = processList.stateTable();
+    for (size_t i : table.slotsInState(static_cast<int>(ProcessState::FINISHED))) {
+        std::cout << processList.at(i)->getProcessName()
+                  << " | State: FINISHED"
+                  << " | Total lines: " << table.lineCount(i)
+                  << "/" << table.lineCount(i)
+                  << "\n";
     }
 
     std::cout << "--------------------------------\n";
@@ -109,38 +107,81 @@ void console::handleScreenLS() {
 
 
 void console::reportUtil() {
-    std::ofstream logFile("csopesy-log.txt", std::ios::app);
-    if (!logFile.is_open()) { std::cerr << "Failed to open log file.\n"; return; }
-
-    int running = 0;
-    int finished = 0;
-
-    for (const auto &p : processList.getAllProcesses()) {
-        if (p->getState() == ProcessState::RUNNING) running++;
-        else finished++;
-    }
-
-    int totalMem = 64;
-    int usedMem = memmgr.getUsedFrames();
+    // Built in memory and appended by the I/O thread, so the REPL never waits on disk.
+    std::ostringstream logFile;
+
+    // Column scans over the registry's ProcessTable; per-process rows come from the same columns.
+    const ProcessTable& table = processList.stateTable();
+    size_t total = table.size();
+    size_t running = table.countInState(static_cast<int>(ProcessState::RUNNING));
+    size_t finished = table.countInState(static_cast<int>(ProcessState::FINISHED));
+    size_t ready = table.countInState(static_cast<int>(ProcessState::READY));
+    size_t sleeping = table.countInState(static_cast<int>(ProcessState::WAITING));
+    long residentKb = table.sumMemoryUsed();
+
+    int totalMem = static_cast<int>(memmgr.getTotalFrames());
+    int usedMem = static_cast<int>(memmgr.peekUsedFrames());
     std::cout << "Memory Usage: " << usedMem << " / " << totalMem << " frames\n";
 
     logFile << "=== Utilization Report ===\n";
     logFile << "Total CPU cores: " << numCPUs << "\n";
-    logFile << "Processes summary:\n";
 
-    int coreIndex = 0;
-    for (const auto &p : processList.getAllProcesses()) {
-        int assignedCore = coreIndex % numCPUs;
+    logFile << "Core placement:\n";
+    const auto& plan = sched.getCoreAffinity();
+    std::vector<int> pinned = sched.pinnedHostCpus();
+    if (sched.isVirtual()) {
+        logFile << "  Virtual time: all simulated cores run on one thread";
+        if (!pinned.empty() && pinned[0] >= 0) logFile << " (host CPU " << pinned[0] << ")";
+        logFile << "\n";
+    } else if (pinned.empty()) {
+        logFile << "  Scheduler not running\n";
+    } else {
+        for (size_t i = 0; i < pinned.size(); ++i) {
+            logFile << "  Core " << i << " -> ";
+            if (pinned[i] < 0) {
+                logFile << "floating\n";
+                continue;
+            }
+            logFile << "host CPU " << pinned[i];
+            if (i < plan.size() && plan[i].numaNode >= 0) logFile << " (NUMA node " << plan[i].numaNode << ")";
+            logFile << "\n";
+        }
+    }
+    logFile << "Per-core counters:\n";
+    for (int i = 0; i < numCPUs; ++i) {
+        long active = coreCounters.ofCore(i, &CounterShard::activeTicks);
+        long idle = coreCounters.ofCore(i, &CounterShard::idleTicks);
+        double util = (active + idle) > 0 ? 100.0 * active / (active + idle) : 0.0;
+        logFile << "  Core " << i
+                << ": active " << active
+                << ", idle " << idle
+                << ", util " << std::fixed << std::setprecision(2) << util << " %"
+                << ", instructions " << coreCounters.ofCore(i, &CounterShard::instructions)
+                << ", page faults " << coreCounters.ofCore(i, &CounterShard::pageFaults)
+                << ", context switches " << coreCounters.ofCore(i, &CounterShard::contextSwitches)
+                << "\n";
+    }
+
+    logFile << "Processes summary:\n";
+    logFile << "  " << total << " processes: " << running << " running, " << finished
+            << " finished, " << ready << " ready, " << sleeping << " sleeping; "
+            << residentKb << " KB in use\n";
+
+    for (size_t i = 0; i < total; ++i) {
+        const auto& p = processList.at(i);
+        int core = table.core(i);
+        ProcessState state = static_cast<ProcessState>(table.state(i));
         logFile << "Process: " << p->getProcessName()
                 << ", PID: " << p->getPid()
-                << ", State: " << (p->getState() == ProcessState::RUNNING ? "RUNNING" : "FINISHED")
-                << ", Current line: " << p->getCurrentLine() << "/" << p->getLineCount()
-                << ", Core: " << assignedCore
+                << ", State: " << (state == ProcessState::RUNNING ? "RUNNING" :
+                                   state == ProcessState::READY ? "READY" :
+                                   state == ProcessState::WAITING ? "WAITING" : "FINISHED")
+                << ", Current line: " << table.line(i) << "/" << table.lineCount(i)
+                << ", Core: " << (core == -1 ? "Unassigned" : std::to_string(core))
                 << "\n";
-        coreIndex++;
     }
 
     logFile << "=== End of Report ===\n\n";
-    logFile.close();
+    fileWriter.submit("csopesy-log.txt", logFile.str(), true);
     std::cout << "Report saved to csopesy-log.txt\n";
 }
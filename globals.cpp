@@ -2,10 +2,14 @@
 #include "process_list.h"
 
 MemoryManager memmgr;
+CoreCounters coreCounters;
+PerfStats perfStats;
+Tracer tracer;
+AsyncWriter fileWriter;
 
-int processCounter = 1;
+std::atomic<int> processCounter{1};
 
 std::atomic<bool> cpuRunning{false};
 std::atomic<bool> generatorRunning{false};
-std::atomic<long> idleTicks{0};
-std::atomic<long> activeTicks{0};
+std::atomic<bool> virtualTime{false};
+std::atomic<long> simTick{0};
@@ -1,7 +1,15 @@
 #pragma once
 #include <atomic>
+#include <chrono>
 
 extern std::atomic<bool> cpuRunning;
 extern std::atomic<bool> generatorRunning;
-extern std::atomic<long> idleTicks;
-extern std::atomic<long> activeTicks;
+extern std::atomic<bool> virtualTime;
+extern std::atomic<long> simTick;
+
+// Scheduler time in ms: the tick count in virtual-time mode, the steady clock otherwise.
+inline long long schedulerClockMs() {
+    if (virtualTime) return simTick.load(std::memory_order_relaxed);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
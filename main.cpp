@@ -10,25 +10,52 @@
 #include "process_list.h"
 #include "console.h"
 #include "Scheduler.h"
+#include "benchmark.h"
+#include "VmStatSampler.h"
+#include "Checkpoint.h"
+#include "workload.h"
 #include <stdexcept>
 #include <iomanip>
 
 int numCPUs = 1;
 std::string schedulerType = "FCFS";
 int quantumCycles = 100;
-int batchProcessFreq = 1;
+double batchProcessFreq = 1;
 int minInstructions = 1;
 int maxInstructions = 10;
 int delaysPerExec = 0;
+int pageFaultTicks = 0;
 int maxOverallMem = 65536; // default total system memory
 int memPerFrame = 256;      // default per-frame memory
 int minMemPerProc = 64;     // default min memory per process
 int maxMemPerProc = 4096;   // default max memory per process
+std::string simulationMode = "real";
+bool cpuAffinity = false;
+bool perfStatsOn = false;
+bool archiveFinished = true; // spill finished processes' logs to csopesy-archive
+uint64_t seed = 1;          // process generator stream, see Rng.h
 
 Scheduler sched;
+VmStatSampler vmSampler;   // declared after sched so it stops first
+
+void applyConfig(Scheduler& s) {
+    s.numCPUs = numCPUs;
+    s.schedulerType = schedulerType;
+    s.quantumCycles = quantumCycles;
+    s.batchProcessFreq = batchProcessFreq;
+    s.minInstructions = minInstructions;
+    s.maxInstructions = maxInstructions;
+    s.minMemPerProc = minMemPerProc;
+    s.maxMemPerProc = maxMemPerProc;
+    s.setSeed(seed);
+    s.delaysPerExec = delaysPerExec;
+    s.pageFaultTicks = pageFaultTicks;
+    s.pinCores = cpuAffinity;
+    s.setArchiving(archiveFinished);
+}
 
-void setConfig() {
-    std::ifstream configFile("config.txt");
+void setConfig(const std::string& path = "config.txt") {
+    std::ifstream configFile(path);
     if (configFile.is_open()) {
         std::string line;
         while (std::getline(configFile, line)) {
@@ -40,60 +67,72 @@ void setConfig() {
             if (key == "num-cpu") numCPUs = std::stoi(value);
             else if (key == "scheduler") schedulerType = value.substr(1, value.size()-2); // remove quotes
             else if (key == "quantum-cycles") quantumCycles = std::stoi(value);
-            else if (key == "batch-process-freq") batchProcessFreq = std::stoi(value);
+            else if (key == "batch-process-freq") batchProcessFreq = std::stod(value);
             else if (key == "min-ins") minInstructions = std::stoi(value);
             else if (key == "max-ins") maxInstructions = std::stoi(value);
             else if (key == "delay-per-exec") delaysPerExec = std::stoi(value);
+            else if (key == "page-fault-ticks") pageFaultTicks = std::stoi(value);
             else if (key == "max-overall-mem") maxOverallMem = std::stoi(value);
             else if (key == "mem-per-frame") memPerFrame = std::stoi(value);
             else if (key == "min-mem-per-proc") minMemPerProc = std::stoi(value);
             else if (key == "max-mem-per-proc") maxMemPerProc = std::stoi(value);
+            else if (key == "simulation-mode") {
+                if (!value.empty() && value.front() == '"') value = value.substr(1, value.size()-2);
+                simulationMode = value;
+            }
+            else if (key == "cpu-affinity") {
+                if (!value.empty() && value.front() == '"') value = value.substr(1, value.size()-2);
+                cpuAffinity = (value == "on" || value == "1" || value == "true");
+            }
+            else if (key == "perf-stats") {
+                if (!value.empty() && value.front() == '"') value = value.substr(1, value.size()-2);
+                perfStatsOn = (value == "on" || value == "1" || value == "true");
+            }
+            else if (key == "archive-finished") {
+                if (!value.empty() && value.front() == '"') value = value.substr(1, value.size()-2);
+                archiveFinished = (value == "on" || value == "1" || value == "true");
+            }
+            else if (key == "seed") seed = std::stoull(value);
         }
         configFile.close();
         std::cout << "Configuration loaded.\n";
     }
 
-    sched.numCPUs = numCPUs;
-    sched.schedulerType = schedulerType;
-    sched.quantumCycles = quantumCycles;
-    sched.batchProcessFreq = batchProcessFreq;
-    sched.minInstructions = minInstructions;
-    sched.maxInstructions = maxInstructions;
-    sched.delaysPerExec = delaysPerExec;
+    applyConfig(sched);
+    memmgr.configure(maxOverallMem / std::max(1, memPerFrame), memPerFrame);
+    virtualTime = (simulationMode == "virtual");
+    perfStats.setEnabled(perfStatsOn);
 }
 
 
 void processSMI(const ProcessList& plist, int totalMemoryKiB) {
-    int usedMemory = 0;
-    int runningProcesses = 0;
-
-    const auto& allProcs = plist.getAllProcesses();
-    for (const auto& pPtr : allProcs) {
-        const Process& p = *pPtr;
-        usedMemory += p.getMemoryUsed();  // memory in KiB
-        if (p.getState() == ProcessState::RUNNING)
-            runningProcesses++;
-    }
+    // Totals come from the incrementally maintained counters, so this is O(1) in history size.
+    long usedMemory = coreCounters.memoryUsed();  // memory in KiB
+    long runningProcesses = coreCounters.countInState(static_cast<int>(ProcessState::RUNNING));
+    size_t totalProcesses = plist.size();
 
     double cpuUtil = 0.0;
-    if (!allProcs.empty())
-        cpuUtil = (runningProcesses * 100.0) / allProcs.size();
+    if (totalProcesses > 0)
+        cpuUtil = (runningProcesses * 100.0) / totalProcesses;
 
     std::cout << "----------------------------------------------\n";
     std::cout << "PROCESS-SMI V01.00 DRIVER VERSION: \n";
     std::cout << "CPU Utilization: " << cpuUtil << " %\n";
     std::cout << "Memory Usage: " << usedMemory / 1024.0 << " MiB / "
               << totalMemoryKiB / 1024.0 << " MiB\n";
-    std::cout << "Memory Utilization: " << (usedMemory * 100.0 / totalMemoryKiB) << " %\n\n";
+    std::cout << "Memory Utilization: " << (usedMemory * 100.0 / totalMemoryKiB) << " %\n";
+    std::cout << "Committed frames: " << memmgr.getCommittedFrames() << " / " << memmgr.getTotalFrames()
+              << " | Awaiting admission: " << sched.admissionQueueLength() << "\n\n";
 
     std::cout << "Running processes and memory usage:\n";
-    for (const auto& pPtr : allProcs) {
-        const Process& p = *pPtr;
-        double memMiB = static_cast<double>(p.getMemoryUsed()) / 1024.0;
+    for (Process* p : sched.runningProcesses()) {
+        ProcessSnapshot s = p->snapshot();
+        double memMiB = static_cast<double>(s.memoryUsed) / 1024.0;
         if (memMiB < 0.01) memMiB = 0.01; // optional minimum display
-        std::cout << p.getProcessName() << " " << memMiB << " MiB"
-                  << " | State: " << (p.getState() == ProcessState::RUNNING ? "RUNNING" :
-                                      p.getState() == ProcessState::READY ? "READY" : "FINISHED")
+        std::cout << p->getProcessName() << " " << memMiB << " MiB"
+                  << " | State: " << (s.state == ProcessState::RUNNING ? "RUNNING" :
+                                      s.state == ProcessState::READY ? "READY" :
+                                      s.state == ProcessState::WAITING ? "WAITING" : "FINISHED")
                   << "\n";
     }
 
@@ -103,37 +142,31 @@ void processSMI(const ProcessList& plist, int totalMemoryKiB) {
 
 
 
-void vmStat(const ProcessList& plist, int totalMemoryBytes, const std::string& filename = "csopesy-vmstat.txt") {
-    int usedMemory = 0;
-    int pagedIn = 0;
-    int pagedOut = 0;
-
-    for (const auto& p : plist.getAllProcesses()) {
-        usedMemory += p->getMemoryUsed();
-        pagedIn += p->getPagedIn();
-        pagedOut += p->getPagedOut();
-    }
-
-    int freeMemory = totalMemoryBytes - usedMemory;
-    long totalCpuTicks = activeTicks.load() + idleTicks.load();
-    double cpuUtil = (totalCpuTicks > 0) ? 100.0 * activeTicks.load() / totalCpuTicks : 0.0;
+void vmStat(int totalMemoryBytes, const std::string& filename = "csopesy-vmstat.txt") {
+    long usedMemory = coreCounters.memoryUsed();
+    long pagedIn = coreCounters.pagedIn();
+    long pagedOut = coreCounters.pagedOut();
 
-    std::ofstream ofs(filename);
-    if (!ofs.is_open()) throw std::runtime_error("Unable to open file: " + filename);
+    long freeMemory = totalMemoryBytes - usedMemory;
+    long activeTicks = coreCounters.activeTicks();
+    long idleTicks = coreCounters.idleTicks();
+    long totalCpuTicks = activeTicks + idleTicks;
+    double cpuUtil = (totalCpuTicks > 0) ? 100.0 * activeTicks / totalCpuTicks : 0.0;
 
+    std::ostringstream ofs;
     ofs << "--------------------------------\n";
     ofs << "Total memory: " << totalMemoryBytes << " bytes\n";
     ofs << "Used memory: " << usedMemory << " bytes (" << std::fixed << std::setprecision(4) << usedMemory / 1024.0 / 1024.0 << " MiB)\n";
     ofs << "Free memory: " << freeMemory << " bytes (" << freeMemory / 1024.0 / 1024.0 << " MiB)\n";
-    ofs << "Idle CPU ticks: " << idleTicks.load() << "\n";
-    ofs << "Active CPU ticks: " << activeTicks.load() << "\n";
+    ofs << "Idle CPU ticks: " << idleTicks << "\n";
+    ofs << "Active CPU ticks: " << activeTicks << "\n";
     ofs << "Total CPU ticks: " << totalCpuTicks << "\n";
     ofs << "CPU Utilization: " << cpuUtil << " %\n";
     ofs << "Num paged in: " << pagedIn << "\n";
     ofs << "Num paged out: " << pagedOut << "\n";
     ofs << "--------------------------------\n";
 
-    ofs.close();
+    fileWriter.submit(filename, ofs.str());
 }
 
 
@@ -161,12 +194,16 @@ bool isPowerOfTwo(int n) {
 }
 
 bool validMemorySize(int memSize) {
-    return memSize >= 64 && memSize <= 216 && isPowerOfTwo(memSize);
+    return memSize >= 64 && memSize <= 65536 && isPowerOfTwo(memSize);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+        return runBenchmark(argc, argv);
+
     printHeader();
-    ProcessList plist;
+    // The REPL and the scheduler share one registry; nothing is copied back and forth.
+    ProcessList& plist = sched.allProcesses;
     std::string command;
 
     while (command != "exit") {
@@ -185,10 +222,17 @@ int main() {
             std::cout << " screen -r <name>               - Re-access process screen\n";
             std::cout << " screen -c <name> <mem> \"inst\"   - Create process with instructions\n";
             std::cout << " screen -ls                     - List all processes\n";
+            std::cout << " load-workload <file>           - Create processes from a file, one per line: <name> <mem> \"inst\"\n";
             std::cout << " scheduler-stop                 - Stop scheduler\n";
             std::cout << " process-smi                    - summarized view of the available/used memory\n";
             std::cout << " vmstat                         - detailed view of the active/inactive processes, available/used memory, and pages.\n";
+            std::cout << " vmstat -n <interval_ms> [file] - Append a vmstat row to a CSV every interval (vmstat -n off stops)\n";
             std::cout << " report-util                    - Generate CPU utilization report\n";
+            std::cout << " perfstat [on|off|reset]        - Per-opcode, page-fault and dispatch latency histograms\n";
+            std::cout << " perfstat dump [file]           - Write per-core histograms to a file\n";
+            std::cout << " trace start | trace stop <file> - Record a scheduling timeline (Chrome trace JSON)\n";
+            std::cout << " checkpoint <file>              - Save the whole emulator state\n";
+            std::cout << " restore <file>                 - Load a checkpoint (before scheduler-start)\n";
             std::cout << " exit                           - Quit program\n";
         }
         else if (command.rfind("screen ", 0) == 0) {
@@ -223,7 +267,7 @@ int main() {
 
                 // Case 2: screen -s <new_process> <mem>
                 if (!validMemorySize(memSize)) {
-                    std::cout << "Invalid memory allocation. Must be between 64-4096 bytes and a power of 2.\n";
+                    std::cout << "Invalid memory allocation. Must be between 64-65536 bytes and a power of 2.\n";
                     continue;
                 }
 
@@ -239,6 +283,7 @@ int main() {
                 }
 
                 auto proc = plist.createProcess(procName, memSize, instructionsStr);
+                sched.admit(proc.get());
 
                 console c(plist, proc.get());
                 c.handleScreen();
@@ -249,9 +294,8 @@ int main() {
                 std::string procName = option.substr(3);
                 try {
                     std::shared_ptr<Process> proc = plist.findProcess(procName);
-                    if (proc->getState() == ProcessState::FINISHED) {
-                        std::cout << "Process " << procName << " not found.\n";
-                    } else if (!proc->isScreened) {
+                    // Finished processes stay reachable; their logs are read back from the archive.
+                    if (!proc->isScreened) {
                         std::cout << "Process " << procName << " has not been accessed before. Use -s first.\n";
                     } else {
                         console c(plist, proc.get());
@@ -283,7 +327,7 @@ int main() {
                 instructionsStr = Instruction::trim(instructionsStr);
 
                 if (!validMemorySize(memSize)) {
-                    std::cout << "Invalid memory allocation. Must be 64-216 bytes and power of 2.\n";
+                    std::cout << "Invalid memory allocation. Must be 64-65536 bytes and power of 2.\n";
                     continue;
                 }
 
@@ -295,11 +339,13 @@ int main() {
 
                     while (proc->getState() != ProcessState::FINISHED) {
                         proc->executeNextInstruction(0);
-                        const auto& logs = proc->getLogs();
-                        if (!logs.empty()) std::cout << logs.back() << "\n";
+                        proc->sleepInline();
+                        std::string last = proc->getLastLog();
+                        if (!last.empty()) std::cout << last << "\n";
                     }
 
                     std::cout << "Process finished.\n";
+                    sched.retire(proc.get());
                 } catch (const std::exception& e) {
                     std::cout << "Error creating process: " << e.what() << "\n";
                 }
@@ -312,32 +358,132 @@ int main() {
             }
         }
         else if (command == "scheduler-start") {
-            sched.allProcesses = plist;
             //sched.start();
             sched.schedulerStart();
         }
         else if (command == "scheduler-stop") {
             sched.schedulerStop();
             std::cout << "Scheduler generator stopped.\n";
-            plist = sched.allProcesses;
             //plist.displayAll();
         }
         else if (command == "scheduler-test") {
-            sched.allProcesses = plist;
             sched.schedulerTest();
-            plist = sched.allProcesses;
         }
 
         else if (command == "process-smi") {
             processSMI(plist, maxOverallMem);
         }
         else if (command == "vmstat") {
-            vmStat(plist, maxOverallMem);
+            vmStat(maxOverallMem);
+        }
+        else if (command.rfind("vmstat -n", 0) == 0) {
+            std::istringstream iss(command.substr(9));
+            std::string interval, filename;
+            iss >> interval >> filename;
+
+            if (interval == "off") {
+                long rows = vmSampler.stop();
+                std::cout << "vmstat sampling stopped (" << rows << " rows).\n";
+                continue;
+            }
+            int intervalMs = 0;
+            try { intervalMs = std::stoi(interval); } catch (...) {}
+            if (intervalMs <= 0) {
+                std::cout << "Usage: vmstat -n <interval_ms> [file] | vmstat -n off\n";
+                continue;
+            }
+            if (filename.empty()) filename = "csopesy-vmstat.csv";
+            try {
+                vmSampler.start(sched, intervalMs, filename);
+                std::cout << "Sampling vmstat every " << intervalMs << " ms into " << filename << ".\n";
+            } catch (const std::exception& e) {
+                std::cout << e.what() << "\n";
+            }
         }
         else if (command == "report-util") {
             console c(plist, nullptr);
             c.reportUtil();
         }
+        else if (command.rfind("perfstat", 0) == 0) {
+            std::istringstream iss(command.substr(8));
+            std::string option, filename;
+            iss >> option >> filename;
+
+            if (option.empty()) {
+                perfStats.print(std::cout, sched.numCPUs);
+            } else if (option == "on" || option == "off") {
+                perfStats.setEnabled(option == "on");
+                std::cout << "Hot-path instrumentation " << option << ".\n";
+            } else if (option == "reset") {
+                perfStats.reset();
+                std::cout << "Latency histograms cleared.\n";
+            } else if (option == "dump") {
+                if (filename.empty()) filename = "csopesy-perf.txt";
+                try {
+                    perfStats.dump(filename, sched.numCPUs);
+                    std::cout << "Latency histograms written to " << filename << ".\n";
+                } catch (const std::exception& e) {
+                    std::cout << e.what() << "\n";
+                }
+            } else {
+                std::cout << "Usage: perfstat [on|off|reset|dump <file>]\n";
+            }
+        }
+        else if (command.rfind("trace ", 0) == 0) {
+            std::istringstream iss(command.substr(6));
+            std::string option, filename;
+            iss >> option >> filename;
+
+            if (option == "start") {
+                if (tracer.active()) {
+                    std::cout << "Trace already running.\n";
+                } else {
+                    tracer.start();
+                    std::cout << "Trace started.\n";
+                }
+            } else if (option == "stop") {
+                if (!tracer.active()) {
+                    std::cout << "No trace running.\n";
+                    continue;
+                }
+                if (filename.empty()) filename = "csopesy-trace.json";
+                try {
+                    size_t events = tracer.stop(filename);
+                    std::cout << "Trace written to " << filename << " (" << events << " events).\n";
+                } catch (const std::exception& e) {
+                    std::cout << e.what() << "\n";
+                }
+            } else {
+                std::cout << "Usage: trace start | trace stop <file>\n";
+            }
+        }
+        else if (command.rfind("load-workload ", 0) == 0) {
+            std::string filename = trim(command.substr(14));
+            try {
+                loadWorkload(sched, filename);
+            } catch (const std::exception& e) {
+                std::cout << e.what() << "\n";
+            }
+        }
+        else if (command.rfind("checkpoint ", 0) == 0 || command.rfind("restore ", 0) == 0) {
+            bool saving = command.rfind("checkpoint ", 0) == 0;
+            std::string filename = trim(command.substr(saving ? 11 : 8));
+            if (filename.empty()) {
+                std::cout << "Usage: checkpoint <file> | restore <file>\n";
+                continue;
+            }
+            try {
+                auto start = std::chrono::steady_clock::now();
+                std::string what = saving
+                    ? std::to_string(saveCheckpoint(sched, filename)) + " bytes"
+                    : std::to_string(restoreCheckpoint(sched, filename)) + " processes";
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                std::cout << (saving ? "Checkpoint written to " : "Restored from ") << filename
+                          << " (" << what << ", " << ms << " ms).\n";
+            } catch (const std::exception& e) {
+                std::cout << e.what() << "\n";
+            }
+        }
         else if (command == "exit") {
             std::cout << "Exiting program.\n";
         }
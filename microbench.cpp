@@ -0,0 +1,253 @@
+// Microbenchmarks for the hot paths, measured in isolation.
+// Build: g++ -std=c++17 -O2 -pthread microbench.cpp instruction.cpp process.cpp process_list.cpp
+//        scheduler.cpp memorymanager.cpp config.cpp globals.cpp -o microbench
+// Run:   ./microbench [--reps N] [--min-ms M] [name-filter]
+#include "Scheduler.h"
+#include "Instruction.h"
+#include "MemoryManager.h"
+#include "Process.h"
+#include "process_list.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+extern MemoryManager memmgr;
+
+// Reaches into the scheduler the same way a core thread does.
+struct SchedulerProbe {
+    static void generate(Scheduler& s, int count = 1) { s.generateProcesses(count); }
+    static Process* dispatch(Scheduler& s) { return s.waitForProcess(); }
+    static void release(Scheduler& s, Process* p) { s.releaseProcess(p); }
+};
+
+using Clock = std::chrono::steady_clock;
+
+// A benchmark runs `ops` operations and returns the nanoseconds they took,
+// so any per-repetition setup stays outside the timed region.
+using BenchFn = std::function<double(long ops)>;
+
+static volatile long sink;
+
+template <typename F>
+static double timeOps(long ops, F&& op) {
+    auto start = Clock::now();
+    for (long i = 0; i < ops; ++i) op(i);
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct Options {
+    int reps = 10;
+    double minMs = 20.0;
+    std::string filter;
+};
+
+static void report(std::ostream& out, const Options& opt, const std::string& name, const BenchFn& fn) {
+    if (!opt.filter.empty() && name.find(opt.filter) == std::string::npos) return;
+
+    // One untimed call first, so lazy setup and cold caches don't skew calibration.
+    // Then grow the batch until one repetition is long enough to time reliably.
+    fn(1);
+    long ops = 1;
+    while (fn(ops) < opt.minMs * 1e6 && ops < (1L << 30)) ops *= 2;
+
+    std::vector<double> perOp;
+    for (int r = 0; r < opt.reps; ++r) perOp.push_back(fn(ops) / ops);
+    std::sort(perOp.begin(), perOp.end());
+
+    double mean = 0;
+    for (double v : perOp) mean += v;
+    mean /= perOp.size();
+    double var = 0;
+    for (double v : perOp) var += (v - mean) * (v - mean);
+    double stddevPct = mean > 0 ? 100.0 * std::sqrt(var / perOp.size()) / mean : 0.0;
+
+    out << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(12) << perOp[perOp.size() / 2]
+        << std::setw(12) << perOp.front()
+        << std::setw(9) << stddevPct << "%"
+        << std::setw(12) << ops << "\n";
+}
+
+static std::unique_ptr<Process> benchProcess(const std::string& name) {
+    auto p = std::make_unique<Process>(0, name, std::vector<Instruction>{});
+    p->symbolTable["x"] = 1;
+    p->symbolTable["y"] = 2;
+    return p;
+}
+
+static void executeBenches(std::ostream& out, const Options& opt) {
+    struct Case { const char* name; Instruction::Type type; const char* params; };
+    const Case cases[] = {
+        { "execute/DECLARE", Instruction::Type::DECLARE, "x 5" },
+        { "execute/ADD",     Instruction::Type::ADD,     "x x y" },
+        { "execute/SUB",     Instruction::Type::SUB,     "x x y" },
+        { "execute/READ",    Instruction::Type::READ,    "r 0x500" },
+        { "execute/WRITE",   Instruction::Type::WRITE,   "0x500 x" },
+        { "execute/PRINT",   Instruction::Type::PRINT,   "x + y" },
+        { "execute/SLEEP",   Instruction::Type::SLEEP,   "2" },
+        { "execute/FOR",     Instruction::Type::FOR,     "" },
+    };
+    for (const Case& c : cases) {
+        Instruction instr(c.type, c.params);
+        report(out, opt, c.name, [&instr](long ops) {
+            memmgr.reset();
+            auto p = benchProcess("bench");   // fresh each repetition so PRINT logs don't pile up
+            return timeOps(ops, [&](long) { instr.execute(p.get()); });
+        });
+    }
+}
+
+static void parseBenches(std::ostream& out, const Options& opt) {
+    const std::vector<std::string> lines = {
+        "DECLARE x 5", "ADD x x y", "SUB x x y", "READ r 0x500",
+        "WRITE 0x500 x", "PRINT x + y", "SLEEP 2", "FOR 3",
+    };
+    report(out, opt, "fromString/mixed", [&lines](long ops) {
+        return timeOps(ops, [&](long i) {
+            sink = static_cast<long>(Instruction::fromString(lines[i % lines.size()]).type);
+        });
+    });
+}
+
+static void memoryBenches(std::ostream& out, const Options& opt) {
+    for (int frames : { 16, 64, 256 }) {
+        std::string suffix = "/" + std::to_string(frames) + "frames";
+
+        // Hits cycle over pages that are all resident; misses cycle over twice as
+        // many pages as there are frames, so FIFO eviction makes every access fault.
+        for (bool hit : { true, false }) {
+            int span = hit ? frames : 2 * frames;
+            std::string kind = hit ? "hit" : "miss";
+
+            report(out, opt, "memmgr.read/" + kind + suffix, [frames, span, hit](long ops) {
+                MemoryManager mm(frames);
+                mm.disableLogging();
+                auto p = benchProcess("bench");
+                if (hit) for (int a = 0; a < span; ++a) mm.read(p.get(), a);
+                return timeOps(ops, [&](long i) { sink = mm.read(p.get(), i % span); });
+            });
+            report(out, opt, "memmgr.write/" + kind + suffix, [frames, span, hit](long ops) {
+                MemoryManager mm(frames);
+                mm.disableLogging();
+                auto p = benchProcess("bench");
+                if (hit) for (int a = 0; a < span; ++a) mm.write(p.get(), a, 0);
+                return timeOps(ops, [&](long i) { mm.write(p.get(), i % span, 1); });
+            });
+        }
+    }
+}
+
+// One dispatch is what a core does per time slice: take the next ready process,
+// then hand it back to the ready queue.
+static void dispatchBenches(std::ostream& out, const Options& opt) {
+    for (int n : { 10, 1000, 100000 }) {
+        Scheduler s;
+        s.minInstructions = s.maxInstructions = 3;
+        for (int i = 0; i < n; ++i) SchedulerProbe::generate(s);
+
+        report(out, opt, "dispatch/" + std::to_string(n) + "procs", [&s](long ops) {
+            return timeOps(ops, [&](long) {
+                Process* p = SchedulerProbe::dispatch(s);
+                SchedulerProbe::release(s, p);
+            });
+        });
+    }
+}
+
+static void constructionBenches(std::ostream& out, const Options& opt) {
+    for (int n : { 10, 100, 1000, 5000 }) {
+        std::string suffix = "/" + std::to_string(n) + "instrs";
+
+        // The whole generator step: template lookup, construct, register, enqueue.
+        report(out, opt, "generate" + suffix, [n](long ops) {
+            Scheduler s;
+            s.minInstructions = s.maxInstructions = n;
+            return timeOps(ops, [&](long) { SchedulerProbe::generate(s); });
+        });
+
+        // The constructor alone, from an already-built instruction list.
+        std::vector<Instruction> instrs(n, Instruction(Instruction::Type::ADD, "x x y"));
+        report(out, opt, "Process()" + suffix, [&instrs](long ops) {
+            return timeOps(ops, [&](long i) {
+                Process p(static_cast<int>(i), "bench", instrs);
+                sink = p.getLineCount();
+            });
+        });
+    }
+}
+
+// A monitoring pass over the whole registry: per-process snapshots vs. the state table.
+static void scanBenches(std::ostream& out, const Options& opt) {
+    for (int n : { 1000, 100000 }) {
+        std::string suffix = "/" + std::to_string(n) + "procs";
+        auto list = std::make_unique<ProcessList>();
+        auto program = std::make_shared<const std::vector<Instruction>>(10, Instruction(Instruction::Type::ADD, "x x y"));
+        for (int i = 0; i < n; ++i) list->addProcess(makeProcess(i, "scan" + std::to_string(i), program));
+
+        report(out, opt, "countRunning/snapshot" + suffix, [&list](long ops) {
+            return timeOps(ops, [&](long) {
+                long running = 0;
+                for (const auto& p : list->getAllProcesses())
+                    if (p->snapshot().state == ProcessState::RUNNING) running++;
+                sink = running;
+            });
+        });
+        report(out, opt, "countRunning/table" + suffix, [&list](long ops) {
+            return timeOps(ops, [&](long) {
+                sink = static_cast<long>(list->stateTable().countInState(static_cast<int>(ProcessState::RUNNING)));
+            });
+        });
+        report(out, opt, "sumMemory/table" + suffix, [&list](long ops) {
+            return timeOps(ops, [&](long) { sink = list->stateTable().sumMemoryUsed(); });
+        });
+    }
+}
+
+static void usage() {
+    std::cerr << "Usage: microbench [--reps N] [--min-ms M] [name-filter]\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--reps" && i + 1 < argc) {
+            opt.reps = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--min-ms" && i + 1 < argc) {
+            opt.minMs = std::stod(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            usage();
+            return 2;
+        } else {
+            opt.filter = arg;
+        }
+    }
+
+    // Scheduler chatter goes to a muted cout; results go to the real stdout.
+    std::ostream out(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+
+    out << std::left << std::setw(36) << "benchmark" << std::right
+        << std::setw(12) << "ns/op(med)" << std::setw(12) << "ns/op(min)"
+        << std::setw(10) << "stddev" << std::setw(12) << "ops/rep" << "\n";
+
+    // Room for every generated process, so admission control never holds one back.
+    memmgr.configure(size_t(1) << 30, 64);
+
+    executeBenches(out, opt);
+    parseBenches(out, opt);
+    memoryBenches(out, opt);
+    dispatchBenches(out, opt);
+    constructionBenches(out, opt);
+    scanBenches(out, opt);
+    return 0;
+}
@@ -2,32 +2,74 @@
 #include <stdexcept>
 #include <thread>
 
-void ProcessList::addProcess(const Process& p) {
-    for (const auto& existing : processes) {
-        if (existing->getProcessName() == p.getProcessName()) {
-            std::cerr << "Warning: Process with name '" << p.getProcessName() << "' already exists.\n";
-            return;
-        }
+ProcessList::~ProcessList() {
+    for (auto& seg : segments)
+        delete[] seg.load();
+}
+
+// Caller holds indexMtx exclusively, which also serializes appends.
+void ProcessList::indexLocked(const std::shared_ptr<Process>& p) {
+    size_t pos = count.load(std::memory_order_relaxed);
+    size_t offset;
+    int seg = segmentOf(pos, offset);
+    if (seg >= MAX_SEGMENTS)
+        throw std::runtime_error("Process registry is full.");
+
+    std::shared_ptr<Process>* slots = segments[seg].load(std::memory_order_relaxed);
+    if (!slots) {
+        slots = new std::shared_ptr<Process>[size_t(1) << (FIRST_SEGMENT_BITS + seg)];
+        segments[seg].store(slots, std::memory_order_release);
     }
+    slots[offset] = p;
+    p->startTracking(table, pos);
+    byName.emplace(p->getProcessName(), pos);
+    byPid.emplace(p->getPid(), pos);
+    count.store(pos + 1, std::memory_order_release);
+}
 
-    auto newProc = std::make_shared<Process>(p);
-    processes.push_back(newProc);
-    std::thread([newProc]() { newProc->run(); }).detach();
+std::shared_ptr<Process> ProcessList::addProcess(std::shared_ptr<Process> p) {
+    std::unique_lock<std::shared_mutex> lock(indexMtx);
+    if (byName.count(p->getProcessName())) {
+        std::cerr << "Warning: Process with name '" << p->getProcessName() << "' already exists.\n";
+        return nullptr;
+    }
+
+    indexLocked(p);
+    return p;
+}
+
+size_t ProcessList::addProcesses(std::vector<std::shared_ptr<Process>>& batch) {
+    std::unique_lock<std::shared_mutex> lock(indexMtx);
+    size_t added = 0;
+    for (auto& p : batch) {
+        if (!p) continue;
+        if (byName.count(p->getProcessName())) {
+            p.reset();
+            continue;
+        }
+        indexLocked(p);
+        added++;
+    }
+    return added;
 }
 
 std::shared_ptr<Process> ProcessList::createProcess(const std::string& name, int memorySize, const std::string& instructionsStr) {
     // Check for duplicate
-    for (const auto& existing : processes) {
-        if (existing->getProcessName() == name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMtx);
+        if (byName.count(name))
             throw std::runtime_error("Process with name '" + name + "' already exists.");
-        }
     }
 
     int id = processCounter++;
-    auto newProc = std::make_shared<Process>(id, name, memorySize, instructionsStr);
-    processes.push_back(newProc);
-
-    std::thread([newProc]() { newProc->run(); }).detach();
+    auto newProc = makeProcess(id, name, memorySize, instructionsStr);
+    {
+        // Parsing ran unlocked, so someone may have taken the name meanwhile.
+        std::unique_lock<std::shared_mutex> lock(indexMtx);
+        if (byName.count(name))
+            throw std::runtime_error("Process with name '" + name + "' already exists.");
+        indexLocked(newProc);
+    }
 
     std::cout << "Added process " << name << " with ID " << id << " and memory " << memorySize << "\n";
 
@@ -35,33 +77,34 @@ std::shared_ptr<Process> ProcessList::createProcess(const std::string& name, int
 }
 
 std::shared_ptr<Process> ProcessList::findProcess(const std::string& name) {
-    for (auto& p : processes) {
-        if (p->getProcessName() == name)
-            return p;
-    }
+    std::shared_lock<std::shared_mutex> lock(indexMtx);
+    auto it = byName.find(name);
+    if (it != byName.end())
+        return at(it->second);
     throw std::runtime_error("Process not found: " + name);
 }
 
 std::shared_ptr<Process> ProcessList::findProcessByPid(int pid) {
-    for (auto& p : processes) {
-        if (p->getPid() == pid)
-            return p;
-    }
+    std::shared_lock<std::shared_mutex> lock(indexMtx);
+    auto it = byPid.find(pid);
+    if (it != byPid.end())
+        return at(it->second);
     throw std::runtime_error("Process not found with PID: " + std::to_string(pid));
 }
 
 void ProcessList::displayAll() const {
-    if (processes.empty()) {
+    if (size() == 0) {
         std::cout << "No processes available.\n";
         return;
     }
 
     //std::cout << "\n=== Process List ===\n";
-    for (const auto &p : processes) {
+    for (const auto &p : getAllProcesses()) {
         std::string stateStr;
         switch (p->getState()) {
             case ProcessState::READY:    stateStr = "Ready"; break;
             case ProcessState::RUNNING:  stateStr = "Running"; break;
+            case ProcessState::WAITING:  stateStr = "Waiting"; break;
             case ProcessState::FINISHED: stateStr = "Finished"; break;
             default:                      stateStr = "Unknown"; break;
         }
@@ -4,17 +4,82 @@
 #include <iostream>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
 #include "Process.h"
 
-extern int processCounter; 
+extern std::atomic<int> processCounter;
 
+// The one process registry shared by the REPL and the scheduler.
+// Storage is append-only: slot i lives in segment k, where segment k holds
+// FIRST_SEGMENT << k slots, so published slots never move. Iteration is
+// lock-free (acquire-load the count, then read slots); appends are serialized.
 class ProcessList {
 private:
-    std::vector<std::shared_ptr<Process>> processes;
+    static constexpr int FIRST_SEGMENT_BITS = 6;
+    static constexpr int MAX_SEGMENTS = 48;
+
+    std::atomic<std::shared_ptr<Process>*> segments[MAX_SEGMENTS] = {};
+    std::atomic<size_t> count{0};
+
+    // Positions in the registry, so lookups and duplicate checks don't scan the list.
+    std::unordered_map<std::string, size_t> byName;
+    std::unordered_map<int, size_t> byPid;
+    mutable std::shared_mutex indexMtx;
+
+    // Hot per-process fields by registry position, for whole-list scans.
+    ProcessTable table;
+
+    static int segmentOf(size_t pos, size_t& offset) {
+        size_t v = pos + (size_t(1) << FIRST_SEGMENT_BITS);
+        int msb = 63 - __builtin_clzll(v);
+        offset = v - (size_t(1) << msb);
+        return msb - FIRST_SEGMENT_BITS;
+    }
+
+    void indexLocked(const std::shared_ptr<Process>& p);
 
 public:
+    class View {
+    private:
+        const ProcessList* list;
+        size_t n;
+
+    public:
+        class iterator {
+        private:
+            const ProcessList* list;
+            size_t pos;
+
+        public:
+            iterator(const ProcessList* l, size_t p) : list(l), pos(p) {}
+            const std::shared_ptr<Process>& operator*() const { return list->at(pos); }
+            iterator& operator++() { ++pos; return *this; }
+            bool operator!=(const iterator& other) const { return pos != other.pos; }
+        };
 
-    void addProcess(const Process& p);
+        View(const ProcessList* l, size_t size) : list(l), n(size) {}
+        iterator begin() const { return iterator(list, 0); }
+        iterator end() const { return iterator(list, n); }
+        size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+        const std::shared_ptr<Process>& operator[](size_t pos) const { return list->at(pos); }
+    };
+
+    ProcessList() = default;
+    ~ProcessList();
+    ProcessList(const ProcessList&) = delete;
+    ProcessList& operator=(const ProcessList&) = delete;
+
+    // Registers a process built in place with makeProcess. Returns nullptr (and leaves
+    // the registry untouched) if the name is taken.
+    std::shared_ptr<Process> addProcess(std::shared_ptr<Process> p);
+
+    // Registers already-built processes under one lock. Returns how many were added;
+    // duplicates are left out and their slots in `batch` reset to nullptr.
+    size_t addProcesses(std::vector<std::shared_ptr<Process>>& batch);
 
     std::shared_ptr<Process> createProcess(const std::string& name, int memorySize, const std::string& instructionsStr);
 
@@ -22,10 +87,22 @@ public:
 
     std::shared_ptr<Process> findProcessByPid(int pid);
 
-    std::vector<std::shared_ptr<Process>>& getAllProcesses() { return processes; }
-    const std::vector<std::shared_ptr<Process>>& getAllProcesses() const { return processes; }
+    // Only slots below a previously observed size() may be read.
+    const std::shared_ptr<Process>& at(size_t pos) const {
+        size_t offset;
+        int seg = segmentOf(pos, offset);
+        return segments[seg].load(std::memory_order_acquire)[offset];
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    // Row i describes at(i); rows are filled before the slot is published.
+    const ProcessTable& stateTable() const { return table; }
+
+    // A stable view of every process published so far; later appends are not included.
+    View getAllProcesses() const { return View(this, size()); }
 
     void displayAll() const;
 
-    
+
 };
@@ -0,0 +1,181 @@
+// Behaviour checks for scheduler and process paths that are easy to regress silently.
+// Build: g++ -std=c++17 -O2 -pthread selftest.cpp checkpoint.cpp instruction.cpp process.cpp
+//        process_list.cpp scheduler.cpp memorymanager.cpp config.cpp globals.cpp -o selftest
+// Run:   ./selftest        (prints each failed check; exit status is the failure count)
+#include "Scheduler.h"
+#include "Instruction.h"
+#include "MemoryManager.h"
+#include "Process.h"
+#include "Checkpoint.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+extern MemoryManager memmgr;
+
+// Reaches into the scheduler the same way a core thread does.
+struct SchedulerProbe {
+    static Suspend step(Scheduler& s, Process* p, int& executed) { return s.step(p, 0, executed); }
+    static void release(Scheduler& s, Process* p) { s.releaseProcess(p); }
+    static void startTimer(Scheduler& s) { s.timerThread = std::thread([&s]() { s.runTimer(); }); }
+};
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #cond "\n"; \
+            failures++;                                                              \
+        }                                                                            \
+    } while (0)
+
+// Only a miss suspends with PAGE_FAULT; touching a resident page is a plain step, so
+// page-fault-ticks never blocks a process on a hit.
+static void residentPageDoesNotSuspend() {
+    memmgr.configure(64, 64);
+    memmgr.reset();
+    Scheduler s;
+    s.pageFaultTicks = 5;
+
+    std::vector<Instruction> program = {
+        Instruction("WRITE 0x500 7"),
+        Instruction("READ r 0x500"),
+        Instruction("WRITE 0x500 8"),
+        Instruction("DECLARE x 1"),
+    };
+    Process p(0, "resident", std::move(program));
+    p.setState(ProcessState::RUNNING);
+    int executed = 0;
+
+    CHECK(SchedulerProbe::step(s, &p, executed) == Suspend::PAGE_FAULT);   // first touch faults
+    CHECK(p.getState() == ProcessState::WAITING);
+    p.setState(ProcessState::RUNNING);
+    CHECK(SchedulerProbe::step(s, &p, executed) == Suspend::NONE);         // resident read
+    CHECK(SchedulerProbe::step(s, &p, executed) == Suspend::NONE);         // resident write
+    CHECK(p.getState() == ProcessState::RUNNING);
+    CHECK(p.symbolTable["r"] == 7);
+    memmgr.reset();
+}
+
+// A sleep that starts after the real-time wheel sat idle lasts its full length, rather
+// than firing on the next timer pass because the wheel's tick was stale.
+static void sleepAfterIdleWheelLastsItsLength() {
+    using namespace std::chrono;
+    cpuRunning = true;
+    Scheduler s;
+    SchedulerProbe::startTimer(s);
+    std::this_thread::sleep_for(milliseconds(100));   // wheel empty, timer thread parked
+
+    Process p(1, "sleeper", std::vector<Instruction>{ Instruction("DECLARE x 1") });
+    p.block(Suspend::SLEEP, 60);
+    auto start = steady_clock::now();
+    SchedulerProbe::release(s, &p);
+
+    std::this_thread::sleep_for(milliseconds(30));
+    CHECK(p.getState() == ProcessState::WAITING);
+    while (p.getState() == ProcessState::WAITING && steady_clock::now() - start < seconds(2))
+        std::this_thread::sleep_for(milliseconds(1));
+    CHECK(p.getState() == ProcessState::READY);
+    CHECK(steady_clock::now() - start >= milliseconds(60));
+    s.stop();   // joins the timer thread before `p` goes away
+}
+
+// A damaged image is rejected before anything is restored, so a retry with a good
+// image still finds a fresh emulator.
+static void corruptCheckpointLeavesEmulatorUntouched() {
+    cpuRunning = false;
+    const std::string path = "selftest-checkpoint.bin";
+    {
+        Scheduler saved;
+        saved.allProcesses.createProcess("ckA", 64, "DECLARE x 1\nDECLARE y 2");
+        saved.allProcesses.createProcess("ckB", 64, "DECLARE z 3");
+        saveCheckpoint(saved, path);
+    }
+    std::string image;
+    {
+        std::ifstream in(path, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    long tickBefore = simTick.load();
+    int counterBefore = processCounter.load();
+
+    Scheduler target;
+    for (const std::string& bad : { image.substr(0, image.size() - 3), image + "junk" }) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bad;
+        bool threw = false;
+        try {
+            restoreCheckpoint(target, path);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        CHECK(threw);
+        CHECK(target.allProcesses.size() == 0);
+        CHECK(simTick.load() == tickBefore);
+        CHECK(processCounter.load() == counterBefore);
+    }
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << image;
+    CHECK(restoreCheckpoint(target, path) == 2);
+    CHECK(target.allProcesses.findProcess("ckB") != nullptr);
+    std::remove(path.c_str());
+}
+
+// A count larger than the rest of the image could hold is rejected up front, instead of
+// sizing a container from it and only then running out of bytes.
+static void oversizedCountIsRejectedBeforeAllocating() {
+    cpuRunning = false;
+    const std::string path = "selftest-checkpoint.bin";
+    std::string lastLine;
+    {
+        Scheduler saved;
+        auto p = saved.allProcesses.createProcess("ckC", 64, "DECLARE x 1");
+        CHECK(p->getLogs().size() == 1);
+        lastLine = p->getLogs().back();
+        saveCheckpoint(saved, path);
+    }
+    std::string image;
+    {
+        std::ifstream in(path, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // The image ends with the process's log book: line count, then the one line.
+    size_t countAt = image.size() - lastLine.size() - 4 - 4;
+    uint32_t huge = 100000000;
+    std::memcpy(&image[countAt], &huge, sizeof huge);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << image;
+
+    Scheduler target;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        restoreCheckpoint(target, path);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    CHECK(error.find("count exceeds image size") != std::string::npos);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+    CHECK(target.allProcesses.size() == 0);
+    std::remove(path.c_str());
+}
+
+int main() {
+    cpuRunning = true;
+    // Scheduler chatter is not part of the results.
+    std::cout.rdbuf(nullptr);
+
+    residentPageDoesNotSuspend();
+    sleepAfterIdleWheelLastsItsLength();
+    corruptCheckpointLeavesEmulatorUntouched();
+    oversizedCountIsRejectedBeforeAllocating();
+
+    cpuRunning = false;
+    if (failures) std::cerr << failures << " check(s) failed\n";
+    else std::cerr << "all checks passed\n";
+    return failures;
+}
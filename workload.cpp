@@ -0,0 +1,117 @@
+#include "workload.h"
+#include "Scheduler.h"
+#include "process_list.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+static const size_t BLOCK_LINES = 4096;   // lines read and parsed per round
+static const size_t ADMIT_BATCH = 256;    // processes registered and queued per lock
+
+struct ParsedLine {
+    std::shared_ptr<Process> proc;
+    std::string error;
+};
+
+// Same syntax as screen -c: name, memory, then the instructions between the outer quotes.
+static ParsedLine parseLine(const std::string& line, int pid) {
+    ParsedLine out;
+    std::istringstream iss(line);
+    std::string name;
+    int memSize;
+    if (!(iss >> name >> memSize)) {
+        out.error = "expected <name> <memory> \"<instructions>\"";
+        return out;
+    }
+    size_t firstQuote = line.find('"');
+    size_t lastQuote = line.rfind('"');
+    if (firstQuote == std::string::npos || lastQuote == firstQuote) {
+        out.error = "instructions string missing or invalid";
+        return out;
+    }
+    std::string instructions = Instruction::trim(line.substr(firstQuote + 1, lastQuote - firstQuote - 1));
+
+    try {
+        out.proc = makeProcess(pid, std::move(name), memSize, instructions);
+    } catch (const std::exception& e) {
+        out.error = e.what();
+    }
+    return out;
+}
+
+size_t loadWorkload(Scheduler& sched, const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("Unable to open file: " + path);
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t admitted = 0, rejected = 0, lineNo = 0;
+    std::vector<std::string> lines;
+    std::vector<size_t> lineNos;
+    std::vector<ParsedLine> parsed;
+
+    while (in) {
+        lines.clear();
+        lineNos.clear();
+        std::string line;
+        while (lines.size() < BLOCK_LINES && std::getline(in, line)) {
+            ++lineNo;
+            line = Instruction::trim(line);
+            if (line.empty() || line[0] == '#') continue;
+            lines.push_back(std::move(line));
+            lineNos.push_back(lineNo);
+        }
+        if (lines.empty()) break;
+
+        // PIDs follow file order; a rejected line leaves its PID unused.
+        int firstPid = processCounter.fetch_add(static_cast<int>(lines.size()));
+        parsed.assign(lines.size(), ParsedLine());
+
+        size_t chunk = (lines.size() + workers - 1) / workers;
+        std::vector<std::thread> pool;
+        for (size_t begin = 0; begin < lines.size(); begin += chunk) {
+            size_t end = std::min(lines.size(), begin + chunk);
+            pool.emplace_back([&, begin, end]() {
+                for (size_t i = begin; i < end; ++i)
+                    parsed[i] = parseLine(lines[i], firstPid + static_cast<int>(i));
+            });
+        }
+        for (auto& t : pool) t.join();
+
+        std::vector<std::shared_ptr<Process>> batch;
+        batch.reserve(ADMIT_BATCH);
+        std::vector<std::string> names;
+        auto flush = [&]() {
+            admitted += sched.allProcesses.addProcesses(batch);
+            sched.admitBatch(batch);
+            for (size_t k = 0; k < batch.size(); ++k) {
+                if (!batch[k] && rejected++ < 10)
+                    std::cout << "  process '" << names[k] << "' already exists\n";
+            }
+            batch.clear();
+            names.clear();
+        };
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            if (!parsed[i].proc) {
+                if (rejected++ < 10)
+                    std::cout << "  line " << lineNos[i] << ": " << parsed[i].error << "\n";
+                continue;
+            }
+            names.push_back(parsed[i].proc->getProcessName());
+            batch.push_back(std::move(parsed[i].proc));
+            if (batch.size() == ADMIT_BATCH) flush();
+        }
+        if (!batch.empty()) flush();
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded " << admitted << " processes from " << path;
+    if (rejected > 0) std::cout << " (" << rejected << " rejected)";
+    std::cout << " in " << ms << " ms.\n";
+    return admitted;
+}
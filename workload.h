@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+
+class Scheduler;
+
+// load-workload <file>: one process per line, in `screen -c` form:
+//     <name> <memory> "<instr>; <instr>; ..."
+// Blank lines and lines starting with '#' are skipped. Lines are parsed in parallel
+// and the resulting processes registered and queued in batches. Returns the number
+// of processes admitted.
+size_t loadWorkload(Scheduler& sched, const std::string& path);